@@ -0,0 +1,28 @@
+#pragma once
+#include <stdint.h>
+
+// Consistent Overhead Byte Stuffing, then the 0x00 delimiter, so a reader
+// can resync on any zero byte. out needs len + len / 254 + 2 bytes.
+static inline uint8_t cobs_encode(uint8_t *out, const uint8_t *in, uint8_t len)
+{
+  uint8_t codePos = 0;
+  uint8_t code = 1;
+  uint8_t o = 1;
+  for (uint8_t i = 0; i < len; i++)
+  {
+    if (in[i])
+    {
+      out[o++] = in[i];
+      code++;
+    }
+    if (!in[i] || code == 0xFF)
+    {
+      out[codePos] = code;
+      codePos = o++;
+      code = 1;
+    }
+  }
+  out[codePos] = code;
+  out[o++] = 0;
+  return o;
+}
@@ -2,11 +2,112 @@
 
 #define BOTH_HOLD_MS 1000
 #define SELECT_WINDOW_MS 3000
+#define DOUBLE_TAP_MS 350        // press to press
+#define INPUT_EDGE_RING_SIZE 16  // paddle edges from the ISRs, power of two
+#define INPUT_EVENT_RING_SIZE 8  // recognized gestures, power of two
 
 // -------- UI timing --------
-#define UI_PERIOD_MS 100 // 10 FPS
+#define UI_PERIOD_MS 100   // 10 FPS for time-based content (debug page)
+#define UI_MIN_FRAME_MS 20 // UI task period: redraw ceiling when watched fields change
 #define DEBOUNCE_MS 40
 
+// -------- Display buffer --------
+// FULL: 1 KB frame in RAM, built once per frame, partial updates per tile.
+// PAGE1/PAGE2: 128/256 B band; the page is drawn again for every band with
+// damage. Pick with -D UI_BUFFER_MODE=1 (see platformio.ini).
+#define UI_BUFFER_FULL 0
+#define UI_BUFFER_PAGE1 1
+#define UI_BUFFER_PAGE2 2
+#ifndef UI_BUFFER_MODE
+#define UI_BUFFER_MODE UI_BUFFER_FULL
+#endif
+
+#define UI_TEXT_CACHE_SIZE 24 // label widths kept by ui_text_width(), UI_TEXT_MAX_LABEL + 5 B each
+#define UI_TEXT_DIGIT_FONTS 4 // fonts with per-digit metrics
+#define UI_TEXT_MAX_LABEL 12  // chars per cached label run
+
+// -------- History (strip chart page) --------
+#define HISTORY_LEN 128       // samples per signal, one byte each; power of two
+#define HISTORY_SAMPLE_MS 100 // 12.8 s across the chart
+
+// -------- Session statistics (stats page) --------
+#define STATS_EWMA_SHIFT 4      // mean follows ~16 samples
+#define STATS_RPM_HIGH 6500     // time above these is counted
+#define STATS_MAP_HIGH 200      // kPa
+#define STATS_LAMBDA_LEAN 1050  // 1/1000
+#define STATS_TPS_HIGH 95       // %
+#define STATS_CLT_HIGH 105      // C
+#define STATS_IAT_HIGH 50       // C
+#define STATS_OILP_LOW 10       // 1/10 bar, time below
+
+// -------- Persistence (EEPROM) --------
+// Odometer, trip and session statistics live in a ring of records across
+// the EEPROM (src/persist/persist.cpp); each save goes to the next slot and
+// is written one byte per task run, so no run waits out a 3.3 ms write.
+#define ODO_INITIAL_KM 423911   // blank EEPROM: the odometer at install
+#define PERSIST_BASE 0          // first EEPROM byte used
+#define PERSIST_SAVE_MS 60000   // periodic save, only on change; also on each new km and on stopping
+#define PERSIST_EVENT_MIN_MS 10000 // km and stop saves at most this often: a flickering speed can't wear the slots
+#define PERSIST_VERSION 1       // bump when PersistRecord changes
+
+// -------- Odometer --------
+// Distance from the speed signal (src/vehicle/odometer.cpp)
+#define ODO_MAX_DT_MS 200 // longest gap between speed frames integrated (<= 255)
+
+// -------- Telemetry (binary stream on Serial) --------
+// A delta frame with 3-5 fields changed is ~12.5 B on the wire, so
+// 115200 baud sustains ~900 samples/s; 1 Mbaud ~8000/s, i.e. any period.
+#define SERIAL_BAUD 1000000        // exact at 16 MHz (U2X); the slcan bridge needs it
+#define TELEMETRY_PERIOD_MS 10     // samples/s = 1000 / this
+#define TELEMETRY_KEYFRAME_MS 1000 // full state at least this often
+
+// -------- slcan bridge (src/can/slcan.h) --------
+// An 8-byte frame is 22 B in ASCII (26 with timestamps) and 15 B binary.
+// A saturated 500 kbps bus carries ~4000 of them per second: at 1 Mbaud
+// ASCII drops from ~99% load (88% with timestamps), binary keeps up; see
+// the limits in src/can/slcan.h.
+// The UART TX buffer is raised to 256 B in platformio.ini so it covers the
+// gaps between CAN task runs.
+#define SLCAN_BITRATE_CODE '6' // only S<n> accepted: 6 = 500 kbps, keep in step with CAN_BITRATE
+#define SLCAN_LINE_MAX 32      // command line buffer
+
+// -------- Shift light --------
+// Shift points per drive mode and gear are in src/shift/shift.cpp
+#define SHIFT_FLASH_MS 80   // panel inverted/normal half period
+#define SHIFT_HYST_RPM 200  // stays lit until RPM drops this far below
+
 #define SPLASH_MS 2000
 #define MODE_ANNOUNCE_MS 1500
 
+
+// -------- CAN --------
+#define CAN_BITRATE CAN_500KBPS
+#define CAN_CLOCK MCP_8MHZ   // crystal on the MCP2515 module
+#define CAN_RX_USE_ISR 1     // 0 = drain the MCP2515 from loop() instead
+#define CAN_RX_RING_SIZE 32  // frames, power of two
+#define CAN_DECODE_BATCH 8   // frames decoded per read_can() call
+#define CAN_MAX_FILTER_IDS 32 // distinct ids considered when fitting MCP2515 filters
+#define CAN_QUIET_MS 1000     // no frames for this long: "NO CAN" screen
+
+// -------- Stale signals --------
+// A widget is greyed out when a signal it shows has not been decoded for
+// its timeout (src/vehicle/stale.cpp picks one per signal)
+#define STALE_TICK_MS 4          // timestamp resolution, power of two; 16-bit ticks wrap after 262 s
+#define STALE_FAST_MS 500        // RPM, MAP, lambda, TPS, gear
+#define STALE_SLOW_MS 3000       // temperatures, oil pressure
+#define STALE_CHECKS_PER_CALL 2  // signals checked per UI task run
+
+// -------- Scheduler (periods in ms, budgets in us) --------
+#define CAN_TASK_PERIOD_MS 1
+#define CAN_TASK_BUDGET_US 1000
+#define INPUT_PERIOD_MS 5
+#define INPUT_TASK_BUDGET_US 500
+#define HISTORY_TASK_BUDGET_US 200
+#define PERSIST_PERIOD_MS 4       // one EEPROM byte per run at most
+#define PERSIST_TASK_BUDGET_US 300
+#define TELEMETRY_TASK_BUDGET_US 400
+#define UI_TASK_BUDGET_US 3000 // per render slice (build or flush)
+#define UI_FLUSH_MAX_ROWS 2    // tile rows per SPI burst when flushing
+#define SCHED_REPORT_MS 5000   // print overruns on Serial, if any
+#define SERIAL_POLL_MS 50      // Serial commands: 'p' dump timings, 'r' reset them, 's' dump stats, 't' reset trip,
+                               // 'T' telemetry on/off, 'b' slcan bridge (see src/can/slcan.h)
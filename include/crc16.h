@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+// CRC-16/CCITT (poly 0x1021, MSB first), bitwise: no table in flash, and
+// the records and frames it covers are short. Start with 0xFFFF.
+static inline uint16_t crc16_ccitt(uint16_t crc, const uint8_t *p, uint16_t len)
+{
+  while (len--)
+  {
+    crc ^= (uint16_t)*p++ << 8;
+    for (uint8_t b = 0; b < 8; b++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
@@ -4,6 +4,7 @@
 #define OLED_RST 8
 
 #define CAN_CS 7
+#define CAN_INT 19 // MCP2515 INT, must be an external interrupt pin (2, 3, 18-21)
 
 #define BTN_MODE 4
 #define BTN_PAGE 5
@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+
+// Single-producer / single-consumer ring buffer.
+//
+// The producer (typically an ISR) only writes `head`, the consumer (loop())
+// only writes `tail`. Both are 8-bit so every access is atomic on AVR and no
+// interrupt masking is needed on the data path. Indices run freely and wrap
+// at 256, so N must be a power of two that divides 256.
+template <typename T, uint8_t N>
+class SpscRing
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  // -------- producer side --------
+
+  // Slot to fill in place, or nullptr if the ring is full (counted as a drop).
+  T *reserve()
+  {
+    if ((uint8_t)(head - tail) >= N)
+    {
+      if (drops != 0xFFFF)
+        drops++;
+      return nullptr;
+    }
+    return &items[head & (N - 1)];
+  }
+
+  // Publish the slot returned by reserve().
+  void commit()
+  {
+    head++;
+    uint8_t used = head - tail;
+    if (used > highWater)
+      highWater = used;
+  }
+
+  bool push(const T &item)
+  {
+    T *slot = reserve();
+    if (!slot)
+      return false;
+    *slot = item;
+    commit();
+    return true;
+  }
+
+  // -------- consumer side --------
+
+  // Oldest item, or nullptr if empty. Valid until pop().
+  const T *front() const
+  {
+    if (head == tail)
+      return nullptr;
+    return &items[tail & (N - 1)];
+  }
+
+  void pop() { tail++; }
+
+  bool pop(T &out)
+  {
+    const T *item = front();
+    if (!item)
+      return false;
+    out = *item;
+    pop();
+    return true;
+  }
+
+  uint8_t size() const { return head - tail; }
+  bool empty() const { return head == tail; }
+  static uint8_t capacity() { return N; }
+
+  // -------- counters --------
+  // drops is 16-bit: read it with the producer's interrupt masked.
+  uint16_t dropCount() const { return drops; }
+  uint8_t highWaterMark() const { return highWater; }
+  void resetStats()
+  {
+    drops = 0;
+    highWater = size();
+  }
+
+private:
+  T items[N];
+  volatile uint8_t head = 0;
+  volatile uint8_t tail = 0;
+  volatile uint16_t drops = 0;
+  volatile uint8_t highWater = 0;
+};
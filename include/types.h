@@ -15,7 +15,9 @@ enum UiMode
 {
   UI_SPLASH,
   UI_PAGES,
-  UI_MODE_ANNOUNCE
+  UI_MODE_ANNOUNCE,
+  UI_MODE_ALARM, // overlay over pages and the announcement
+  UI_NO_CAN      // bus quiet: replaces everything but the splash
 };
 
 enum DriveMode : uint8_t
@@ -32,86 +34,51 @@ enum PageId : uint8_t
   PAGE_MAIN = 0,
   PAGE_SENSORS,
   PAGE_FUEL,
+  PAGE_BOOST,
+  PAGE_CHART,
+  PAGE_STATS,
   PAGE_DEBUG,
   PAGE_COUNT
 };
 
+// -------- VehicleState fields, addressable by id --------
+// Used by the CAN signal table and anything that tracks per-field changes.
+enum SignalId : uint8_t
+{
+  SIG_RPM,
+  SIG_MAP,
+  SIG_LAMBDA, // 1/1000
+  SIG_TPS,
+  SIG_CLT,
+  SIG_IAT,
+  SIG_OILP, // 1/10 bar
+  SIG_SPEED, // 1/10 km/h
+  SIG_ODO,
+  SIG_TRIP,
+  SIG_GEAR,
+  SIG_PRND,
+  SIG_DRIVE_MODE,
+  SIG_COUNT
+};
+
+typedef uint32_t SignalMask;
+#define SIG_BIT(s) ((SignalMask)1 << (s))
+
+// Fixed point throughout so decoding and formatting stay integer-only.
+// Widest fields first to keep the struct packed.
 struct VehicleState
 {
+  uint32_t odo = ODO_INITIAL_KM; // km, restored by persist_init()
+  uint32_t trip = 0;             // km since the last trip reset
   int16_t rpm = 0;
   int16_t map_kpa = 0;
-  float lambda = 1.0f;
-  int tps = 0;    // %
-  int clt = 0;    // coolant C
-  int iat = 0;    // intake C
-  float oilp = 0; // bar/psi
-  uint32_t odo = 423911;
-  int8_t gear = 0; // -1=R, 0=N, 1..n
+  uint16_t lambda = 1000; // 1/1000, 1000 = stoich
+  uint16_t oilp = 0;      // 1/10 bar
+  uint16_t speed = 0;     // 1/10 km/h
+  int16_t clt = 0;        // coolant C
+  int8_t iat = 0;         // intake C
+  uint8_t tps = 0;        // %
+  int8_t gear = 0;        // -1=R, 0=N, 1..n
   Prnd prnd = PRND_P;
   DriveMode driveMode = MODE_COMFORT;
 };
-
-
-struct Button
-{
-  uint8_t pin;
-  bool stable = true; // stable logical level (true = HIGH because pullup)
-  bool lastRead = true;
-  uint32_t lastChangeMs = 0;
-
-  void begin(uint8_t p)
-  {
-    pin = p;
-    pinMode(pin, INPUT_PULLUP);
-    stable = digitalRead(pin);
-    lastRead = stable;
-    lastChangeMs = millis();
-  }
-
-  // Returns true once per press (on stable transition HIGH->LOW)
-  bool pressed()
-  {
-    bool r = digitalRead(pin);
-    uint32_t now = millis();
-
-    if (r != lastRead)
-    {
-      lastRead = r;
-      lastChangeMs = now;
-    }
-
-    if ((now - lastChangeMs) >= DEBOUNCE_MS && r != stable)
-    {
-      bool prev = stable;
-      stable = r;
-      if (prev == HIGH && stable == LOW)
-        return true; // pressed
-      Serial.print("button ");
-      Serial.print(pin);
-      Serial.println(" pressed");
-    }
-    return false;
-  }
-
-  // call every loop; returns true once on press edge (HIGH->LOW)
-  bool pressedEdge()
-  {
-    bool r = digitalRead(pin);
-    uint32_t now = millis();
-    if (r != lastRead)
-    {
-      lastRead = r;
-      lastChangeMs = now;
-    }
-    if ((now - lastChangeMs) >= DEBOUNCE_MS && r != stable)
-    {
-      bool prev = stable;
-      stable = r;
-      if (prev == HIGH && stable == LOW)
-        return true;
-    }
-    return false;
-  }
-
-  bool isPressedNow() const { return stable == LOW; }
-};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+// Host stand-in for the Arduino core, just enough for this firmware.
+// Time is virtual (see native_harness.h) so runs are deterministic.
+// Also force-included into U8g2's sources, so keep the C++ parts guarded.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define NUM_DIGITAL_PINS 70
+
+// No separate flash address space on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+
+#define digitalPinToInterrupt(p) (p)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+void attachInterrupt(uint8_t interruptNum, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts(void);
+void interrupts(void);
+
+#ifdef __cplusplus
+}
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#include "Print.h"
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud) { this->baud = baud; }
+  void end() {}
+  int available();
+  int read();
+  int peek();
+  int availableForWrite();
+  void flush() {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  operator bool() const { return true; }
+
+  unsigned long baud = 0;
+};
+
+extern HardwareSerial Serial;
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n)
+  {
+    size_t done = 0;
+    while (n--)
+      done += write(*buf++);
+    return done;
+  }
+  size_t write(const char *s) { return s ? write((const uint8_t *)s, strlen(s)) : 0; }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC)
+  {
+    if (base != DEC)
+      return print((unsigned long)v, base);
+    char b[24];
+    snprintf(b, sizeof(b), "%ld", v);
+    return write(b);
+  }
+  size_t print(unsigned long v, int base = DEC)
+  {
+    char b[24];
+    snprintf(b, sizeof(b), base == HEX ? "%lX" : "%lu", v);
+    return write(b);
+  }
+  size_t print(double v, int digits = 2)
+  {
+    char b[32];
+    snprintf(b, sizeof(b), "%.*f", digits, v);
+    return write(b);
+  }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T v) { return print(v) + println(); }
+  template <typename T>
+  size_t println(T v, int fmt) { return print(v, fmt) + println(); }
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+struct SPISettings
+{
+  SPISettings() {}
+  SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+// Devices are emulated at the driver level (MCP_CAN, U8g2 byte callback).
+// Bytes the firmware sends itself go to the MCP_CAN emulation, which acts
+// on them while its chip select is low.
+uint8_t native_mcp_spi_transfer(uint8_t b);
+
+class SPIClass
+{
+public:
+  void begin() {}
+  void end() {}
+  void usingInterrupt(uint8_t) {}
+  void beginTransaction(SPISettings) {}
+  void endTransaction() {}
+  uint8_t transfer(uint8_t b) { return native_mcp_spi_transfer(b); }
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,279 @@
+#include "Arduino.h"
+#include "SPI.h"
+#include "native_harness.h"
+#include <new>
+#include <stdlib.h>
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+// -------- clock --------
+static uint64_t nowUs = 0;
+
+uint64_t native_clock_us()
+{
+  return nowUs;
+}
+
+void native_clock_advance_us(uint32_t us)
+{
+  nowUs += us;
+}
+
+uint32_t millis()
+{
+  return (uint32_t)(nowUs / 1000);
+}
+
+uint32_t micros()
+{
+  return (uint32_t)nowUs;
+}
+
+void delay(uint32_t ms)
+{
+  nowUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  nowUs += us;
+}
+
+// -------- interrupts --------
+struct PinIrq
+{
+  void (*isr)();
+  int mode;
+  bool pending;
+};
+
+static PinIrq irqs[NUM_DIGITAL_PINS];
+static bool irqMasked = false;
+
+static void run_pending_isrs()
+{
+  bool ran = true;
+  while (ran && !irqMasked)
+  {
+    ran = false;
+    for (uint8_t p = 0; p < NUM_DIGITAL_PINS; p++)
+    {
+      if (!irqs[p].pending || !irqs[p].isr)
+        continue;
+      irqs[p].pending = false;
+      // Like AVR: interrupts stay off while an ISR runs
+      irqMasked = true;
+      irqs[p].isr();
+      irqMasked = false;
+      ran = true;
+    }
+  }
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*isr)(void), int mode)
+{
+  if (interruptNum >= NUM_DIGITAL_PINS)
+    return;
+  irqs[interruptNum].isr = isr;
+  irqs[interruptNum].mode = mode;
+  irqs[interruptNum].pending = false;
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+  if (interruptNum < NUM_DIGITAL_PINS)
+    irqs[interruptNum].isr = nullptr;
+}
+
+void noInterrupts()
+{
+  irqMasked = true;
+}
+
+void interrupts()
+{
+  irqMasked = false;
+  run_pending_isrs();
+}
+
+// -------- GPIO --------
+static uint8_t pinLevel[NUM_DIGITAL_PINS];
+static uint8_t pinModes[NUM_DIGITAL_PINS];
+
+static void pin_edge(uint8_t pin, uint8_t from, uint8_t to)
+{
+  PinIrq &irq = irqs[pin];
+  if (!irq.isr || from == to)
+    return;
+  if (irq.mode == CHANGE || (irq.mode == FALLING && to == LOW) || (irq.mode == RISING && to == HIGH))
+  {
+    irq.pending = true;
+    run_pending_isrs();
+  }
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  pinModes[pin] = mode;
+  if (mode == INPUT_PULLUP)
+    pinLevel[pin] = HIGH;
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pin < NUM_DIGITAL_PINS ? pinLevel[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  if (pin < NUM_DIGITAL_PINS)
+    pinLevel[pin] = val ? HIGH : LOW;
+}
+
+void native_gpio_set(uint8_t pin, uint8_t level)
+{
+  if (pin >= NUM_DIGITAL_PINS)
+    return;
+  uint8_t prev = pinLevel[pin];
+  pinLevel[pin] = level ? HIGH : LOW;
+  pin_edge(pin, prev, pinLevel[pin]);
+}
+
+uint8_t native_gpio_get(uint8_t pin)
+{
+  return pin < NUM_DIGITAL_PINS ? pinLevel[pin] : LOW;
+}
+
+// -------- Serial --------
+// TX is paced at the baud rate given to begin(): a SERIAL_TX_BUFFER_SIZE
+// buffer (the core's default unless the build sets it) drains one byte per
+// 10 bit times, and write() into a full buffer waits like the AVR core does
+// (charged to the virtual clock).
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+static FILE *serialSink = stdout;
+static uint64_t txDoneUs = 0; // when the last queued byte is out
+static NativeSerialStats serialStats;
+static uint8_t rxBuf[1024];
+static size_t rxHead = 0, rxTail = 0;
+
+void native_serial_set_sink(FILE *f)
+{
+  serialSink = f;
+}
+
+void native_serial_feed(const uint8_t *data, size_t len)
+{
+  while (len--)
+  {
+    size_t next = (rxHead + 1) % sizeof(rxBuf);
+    if (next == rxTail)
+      return; // like the UART: overflow drops
+    rxBuf[rxHead] = *data++;
+    rxHead = next;
+  }
+}
+
+int HardwareSerial::available()
+{
+  return (int)((rxHead + sizeof(rxBuf) - rxTail) % sizeof(rxBuf));
+}
+
+int HardwareSerial::read()
+{
+  if (rxHead == rxTail)
+    return -1;
+  uint8_t c = rxBuf[rxTail];
+  rxTail = (rxTail + 1) % sizeof(rxBuf);
+  return c;
+}
+
+int HardwareSerial::peek()
+{
+  return rxHead == rxTail ? -1 : rxBuf[rxTail];
+}
+
+static uint32_t byte_us(unsigned long baud)
+{
+  return baud ? (10000000UL + baud - 1) / baud : 0;
+}
+
+int HardwareSerial::availableForWrite()
+{
+  uint32_t us = byte_us(baud);
+  if (!us || txDoneUs <= nowUs)
+    return SERIAL_TX_BUFFER_SIZE - 1;
+  uint64_t queued = (txDoneUs - nowUs + us - 1) / us;
+  return queued >= SERIAL_TX_BUFFER_SIZE - 1 ? 0 : (int)(SERIAL_TX_BUFFER_SIZE - 1 - queued);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  uint32_t us = byte_us(baud);
+  if (us)
+  {
+    while (availableForWrite() == 0)
+    {
+      nowUs += us;
+      serialStats.blockedUs += us;
+    }
+    txDoneUs = (txDoneUs > nowUs ? txDoneUs : nowUs) + us;
+  }
+  serialStats.bytes++;
+  if (serialSink)
+    fputc(c, serialSink);
+  return 1;
+}
+
+NativeSerialStats native_serial_stats()
+{
+  return serialStats;
+}
+
+// -------- heap --------
+// The firmware itself never allocates; this catches libraries that do.
+static uint32_t heapBytes = 0;
+
+uint32_t native_heap_bytes()
+{
+  return heapBytes;
+}
+
+void *operator new(size_t n)
+{
+  heapBytes += n;
+  void *p = malloc(n ? n : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t n)
+{
+  return operator new(n);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+  free(p);
+}
@@ -0,0 +1,23 @@
+#pragma once
+// Host stand-in for avr-libc's EEPROM access, backed by the emulated
+// EEPROM in native_eeprom.cpp (see native_eeprom_* in native_harness.h).
+#include <stdint.h>
+#include <stddef.h>
+
+#define E2END 0xFFF // ATmega2560: 4 KB
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+int native_eeprom_ready(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define eeprom_is_ready() native_eeprom_ready()
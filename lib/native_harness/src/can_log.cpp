@@ -0,0 +1,98 @@
+#include "can_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static int hex_nibble(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c = tolower(c);
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+// (1436509052.249713) can0 123#DEADBEEF
+static bool parse_candump(const char *line, double &t, LoggedFrame &f)
+{
+  char iface[32], frame[64];
+  if (sscanf(line, " (%lf) %31s %63s", &t, iface, frame) != 3)
+    return false;
+
+  char *hash = strchr(frame, '#');
+  if (!hash)
+    return false;
+  *hash = '\0';
+  f.id = strtoul(frame, nullptr, 16);
+  if (strlen(frame) > 3)
+    f.id |= 0x80000000UL;
+
+  const char *p = hash + 1;
+  if (*p == 'R')
+    p = ""; // remote frame: no payload
+  f.len = 0;
+  while (f.len < 8 && hex_nibble(p[0]) >= 0 && hex_nibble(p[1]) >= 0)
+  {
+    f.data[f.len++] = (hex_nibble(p[0]) << 4) | hex_nibble(p[1]);
+    p += 2;
+  }
+  return true;
+}
+
+//    0.010000 1  123             Rx   d 8 01 02 03 04 05 06 07 08
+static bool parse_asc(const char *line, double &t, LoggedFrame &f)
+{
+  char chan[16], idTxt[16], dir[8], type[4];
+  unsigned dlc;
+  int used = 0;
+  if (sscanf(line, " %lf %15s %15s %7s %3s %u%n", &t, chan, idTxt, dir, type, &dlc, &used) != 6)
+    return false;
+  if (!isdigit((unsigned char)chan[0]) || strcmp(type, "d") != 0)
+    return false;
+
+  size_t n = strlen(idTxt);
+  bool ext = n && (idTxt[n - 1] == 'x' || idTxt[n - 1] == 'X');
+  f.id = strtoul(idTxt, nullptr, 16) | (ext ? 0x80000000UL : 0);
+
+  const char *p = line + used;
+  f.len = 0;
+  while (f.len < dlc && f.len < 8)
+  {
+    unsigned b;
+    int adv = 0;
+    if (sscanf(p, " %2x%n", &b, &adv) != 1)
+      return false;
+    f.data[f.len++] = (uint8_t)b;
+    p += adv;
+  }
+  return true;
+}
+
+bool can_log_load(const char *path, std::vector<LoggedFrame> &frames)
+{
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return false;
+
+  char line[512];
+  bool haveStart = false;
+  double start = 0;
+  while (fgets(line, sizeof(line), fp))
+  {
+    LoggedFrame f = {};
+    double t;
+    if (!parse_candump(line, t, f) && !parse_asc(line, t, f))
+      continue;
+    if (!haveStart)
+    {
+      start = t;
+      haveStart = true;
+    }
+    f.tUs = (uint64_t)((t - start) * 1e6 + 0.5);
+    frames.push_back(f);
+  }
+  fclose(fp);
+  return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+struct LoggedFrame
+{
+  uint64_t tUs; // from the first frame in the log
+  uint32_t id;  // bit 31 set for extended ids
+  uint8_t len;
+  uint8_t data[8];
+};
+
+// Load a candump -l log ("(sec.usec) can0 123#DEADBEEF") or a Vector ASC
+// trace. The format is detected per line. Returns false if the file can't be
+// read; lines that aren't frames are skipped.
+bool can_log_load(const char *path, std::vector<LoggedFrame> &frames);
@@ -0,0 +1,56 @@
+#pragma once
+// Host stand-in for coryjfowler's MCP_CAN. Frames injected through
+// native_can_inject() land in two emulated RX buffers behind the
+// programmed masks/filters, and the INT pin follows them like the real
+// MCP2515, so the firmware's ISR path runs unchanged.
+#include "Arduino.h"
+
+#define INT8U uint8_t
+#define INT32U unsigned long
+
+#define CAN_OK 0
+#define CAN_FAILINIT 1
+#define CAN_FAILTX 2
+#define CAN_MSGAVAIL 3
+#define CAN_NOMSG 4
+#define CAN_CTRLERROR 5
+#define CAN_FAIL 0xFF
+
+#define MCP_ANY 0
+#define MCP_STD 1
+#define MCP_EXT 2
+#define MCP_STDEXT 3
+
+#define MCP_NORMAL 0x00
+#define MCP_SLEEP 0x20
+#define MCP_LOOPBACK 0x40
+#define MCP_LISTENONLY 0x60
+
+#define MCP_20MHZ 0
+#define MCP_16MHZ 1
+#define MCP_8MHZ 2
+
+#define CAN_125KBPS 10
+#define CAN_250KBPS 12
+#define CAN_500KBPS 15
+#define CAN_1000KBPS 18
+
+class MCP_CAN
+{
+public:
+  MCP_CAN(INT8U cs) : cs(cs) {}
+
+  INT8U begin(INT8U idmodeset, INT8U speedset, INT8U clockset);
+  INT8U init_Mask(INT8U num, INT8U ext, INT32U ulData);
+  INT8U init_Filt(INT8U num, INT8U ext, INT32U ulData);
+  INT8U setMode(INT8U opMode);
+  INT8U checkReceive();
+  INT8U readMsgBuf(INT32U *id, INT8U *len, INT8U *buf);
+  INT8U sendMsgBuf(INT32U id, INT8U len, INT8U *buf);
+  INT8U checkError();
+  INT8U getError();
+  INT8U errorCountRX();
+
+private:
+  INT8U cs;
+};
@@ -0,0 +1,222 @@
+#include "mcp_can.h"
+#include "native_harness.h"
+
+#define NO_PIN 0xFF
+#define STD_MASK 0x7FF
+#define EXT_MASK 0x1FFFFFFFUL
+#define SID_BITS (STD_MASK << 18) // standard id bits of a 29-bit mask/filter
+#define EFLG_RX1OVR 0x80
+#define EFLG_RXOVR 0xC0 // the EFLG bits the MCU can clear
+#define MCP_BIT_MODIFY 0x05
+#define MCP_EFLG 0x2D
+
+struct RxBuffer
+{
+  bool full;
+  uint32_t id;
+  uint8_t len;
+  uint8_t data[8];
+};
+
+// Masks and filters as the MCP2515 holds them: 29 bits, the standard id in
+// the top 11. Standard frames compare only those; a filter matches frames
+// of its own kind (EXIDE) only.
+struct Filter
+{
+  uint32_t id;
+  bool ext;
+};
+
+// One emulated controller; the firmware owns a single MCP_CAN
+static struct
+{
+  bool running;
+  uint8_t idMode;
+  uint32_t mask[2];
+  Filter filt[6];
+  uint8_t eflg;
+  RxBuffer rx[2];
+  uint8_t intPin = NO_PIN;
+  uint8_t csPin = NO_PIN;
+  uint8_t spi[4]; // instruction bytes so far
+  uint8_t spiLen;
+  NativeCanStats stats;
+} mcp;
+
+static void update_int_pin()
+{
+  if (mcp.intPin == NO_PIN)
+    return;
+  // INT is active low while any RX buffer holds a frame
+  native_gpio_set(mcp.intPin, (mcp.rx[0].full || mcp.rx[1].full) ? LOW : HIGH);
+}
+
+static bool filter_hit(uint32_t id, bool ext, uint8_t mask, uint8_t first, uint8_t count)
+{
+  uint32_t key = ext ? id & EXT_MASK : (id & STD_MASK) << 18;
+  uint32_t m = ext ? mcp.mask[mask] : mcp.mask[mask] & SID_BITS;
+  for (uint8_t f = first; f < first + count; f++)
+    if (mcp.filt[f].ext == ext && (key & m) == (mcp.filt[f].id & m))
+      return true;
+  return false;
+}
+
+// init_Mask/init_Filt data: a 29-bit id when ext, else the 11-bit id << 16
+static uint32_t to_29bit(INT8U ext, INT32U ulData)
+{
+  return ext ? ulData & EXT_MASK : ((ulData >> 16) & STD_MASK) << 18;
+}
+
+void native_can_set_int_pin(uint8_t pin)
+{
+  mcp.intPin = pin;
+  update_int_pin();
+}
+
+bool native_can_inject(uint32_t id, uint8_t len, const uint8_t *data)
+{
+  mcp.stats.injected++;
+  if (!mcp.running)
+    return false;
+
+  bool ext = id > STD_MASK;
+  bool toRxb0, toRxb1;
+  if (mcp.idMode == MCP_ANY)
+  {
+    toRxb0 = toRxb1 = true;
+  }
+  else
+  {
+    toRxb0 = filter_hit(id, ext, 0, 0, 2);
+    toRxb1 = filter_hit(id, ext, 1, 2, 4);
+  }
+  if (!toRxb0 && !toRxb1)
+  {
+    mcp.stats.filtered++;
+    return false;
+  }
+
+  // RXB0 matches roll over into RXB1 (mcp_can enables BUKT)
+  RxBuffer *slot = nullptr;
+  if (toRxb0 && !mcp.rx[0].full)
+    slot = &mcp.rx[0];
+  else if (!mcp.rx[1].full)
+    slot = &mcp.rx[1];
+  if (!slot)
+  {
+    mcp.stats.overflow++;
+    mcp.eflg |= EFLG_RX1OVR; // set until the firmware clears it
+    return false;
+  }
+
+  slot->full = true;
+  slot->id = ext ? (id | 0x80000000UL) : id;
+  slot->len = len > 8 ? 8 : len;
+  memcpy(slot->data, data, slot->len);
+  update_int_pin();
+  return true;
+}
+
+// Only BIT MODIFY is decoded, the one instruction the firmware sends itself
+// (to clear RXnOVR). Bytes with chip select high are for another device.
+uint8_t native_mcp_spi_transfer(uint8_t b)
+{
+  if (mcp.csPin == NO_PIN || native_gpio_get(mcp.csPin) != LOW)
+  {
+    mcp.spiLen = 0;
+    return 0xFF;
+  }
+  mcp.spi[mcp.spiLen++] = b;
+  if (mcp.spi[0] != MCP_BIT_MODIFY || mcp.spiLen == sizeof(mcp.spi))
+  {
+    if (mcp.spiLen == sizeof(mcp.spi) && mcp.spi[1] == MCP_EFLG)
+    {
+      uint8_t mask = mcp.spi[2] & EFLG_RXOVR;
+      mcp.eflg = (mcp.eflg & ~mask) | (mcp.spi[3] & mask);
+    }
+    mcp.spiLen = 0;
+  }
+  return 0xFF;
+}
+
+NativeCanStats native_can_stats()
+{
+  return mcp.stats;
+}
+
+INT8U MCP_CAN::begin(INT8U idmodeset, INT8U, INT8U)
+{
+  memset(&mcp.rx, 0, sizeof(mcp.rx));
+  mcp.csPin = cs;
+  mcp.spiLen = 0;
+  mcp.idMode = idmodeset;
+  // Like the library: receive-all until masks are programmed
+  mcp.mask[0] = mcp.mask[1] = 0;
+  memset(mcp.filt, 0, sizeof(mcp.filt));
+  mcp.eflg = 0;
+  mcp.running = false;
+  update_int_pin();
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::init_Mask(INT8U num, INT8U ext, INT32U ulData)
+{
+  if (num > 1)
+    return CAN_FAIL;
+  mcp.mask[num] = to_29bit(ext, ulData);
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::init_Filt(INT8U num, INT8U ext, INT32U ulData)
+{
+  if (num > 5)
+    return CAN_FAIL;
+  mcp.filt[num].id = to_29bit(ext, ulData);
+  mcp.filt[num].ext = ext;
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::setMode(INT8U opMode)
+{
+  mcp.running = opMode == MCP_NORMAL || opMode == MCP_LISTENONLY;
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::checkReceive()
+{
+  return (mcp.rx[0].full || mcp.rx[1].full) ? CAN_MSGAVAIL : CAN_NOMSG;
+}
+
+INT8U MCP_CAN::readMsgBuf(INT32U *id, INT8U *len, INT8U *buf)
+{
+  RxBuffer *slot = mcp.rx[0].full ? &mcp.rx[0] : (mcp.rx[1].full ? &mcp.rx[1] : nullptr);
+  if (!slot)
+    return CAN_NOMSG;
+  *id = slot->id;
+  *len = slot->len;
+  memcpy(buf, slot->data, slot->len);
+  slot->full = false;
+  mcp.stats.read++;
+  update_int_pin();
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::sendMsgBuf(INT32U, INT8U, INT8U *)
+{
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::checkError()
+{
+  return CAN_OK;
+}
+
+INT8U MCP_CAN::getError()
+{
+  return mcp.eflg;
+}
+
+INT8U MCP_CAN::errorCountRX()
+{
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "native_display.h"
+
+// -------- Emulated SSD1306 --------
+// Page addressing mode only, which is what U8g2 uses: 0xB0|page selects
+// the page, 0x0n/0x1n set the column, data bytes write 8 vertical pixels.
+
+static struct
+{
+  uint8_t gram[8][NATIVE_PANEL_W];
+  bool dc; // true = data
+  uint8_t page, col;
+  uint8_t skipArgs; // argument bytes of the last command still to come
+  bool inverted;
+  uint32_t bytes, dataBytes, writes;
+} panel;
+
+static uint8_t command_args(uint8_t c)
+{
+  switch (c)
+  {
+  case 0x81: // contrast
+  case 0x20: // memory mode
+  case 0xA8: // multiplex
+  case 0xD3: // offset
+  case 0xD5: // clock
+  case 0xD9: // precharge
+  case 0xDA: // com pins
+  case 0xDB: // vcomh
+  case 0x8D: // charge pump
+    return 1;
+  case 0x21: // column range
+  case 0x22: // page range
+  case 0xA3: // vertical scroll area
+    return 2;
+  case 0x29:
+  case 0x2A:
+    return 5;
+  case 0x26:
+  case 0x27:
+    return 6;
+  default:
+    return 0;
+  }
+}
+
+static void panel_command(uint8_t c)
+{
+  if (panel.skipArgs)
+  {
+    panel.skipArgs--;
+    return;
+  }
+  if (c <= 0x0F)
+    panel.col = (panel.col & 0xF0) | c;
+  else if (c <= 0x1F)
+    panel.col = (panel.col & 0x0F) | ((c & 0x0F) << 4);
+  else if (c >= 0xB0 && c <= 0xB7)
+    panel.page = c & 0x07;
+  else if (c == 0xA6 || c == 0xA7)
+    panel.inverted = c == 0xA7;
+  else
+    panel.skipArgs = command_args(c);
+}
+
+static void panel_data(uint8_t d)
+{
+  panel.dataBytes++;
+  if (panel.col < NATIVE_PANEL_W)
+    panel.gram[panel.page][panel.col] = d;
+  panel.col++;
+}
+
+extern "C" uint8_t native_ssd1306_byte_cb(u8x8_t *, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  switch (msg)
+  {
+  case U8X8_MSG_BYTE_SEND:
+  {
+    const uint8_t *p = (const uint8_t *)arg_ptr;
+    for (uint8_t i = 0; i < arg_int; i++)
+    {
+      panel.bytes++;
+      if (panel.dc)
+        panel_data(p[i]);
+      else
+        panel_command(p[i]);
+    }
+    break;
+  }
+  case U8X8_MSG_BYTE_SET_DC:
+    panel.dc = arg_int != 0;
+    break;
+  case U8X8_MSG_BYTE_END_TRANSFER:
+    panel.writes++;
+    break;
+  default:
+    break;
+  }
+  return 1;
+}
+
+extern "C" uint8_t native_gpio_and_delay_cb(u8x8_t *, uint8_t, uint8_t, void *)
+{
+  return 1;
+}
+
+const uint8_t *native_panel_gram()
+{
+  return &panel.gram[0][0];
+}
+
+bool native_panel_pixel(uint8_t x, uint8_t y)
+{
+  if (x >= NATIVE_PANEL_W || y >= NATIVE_PANEL_H)
+    return false;
+  bool on = (panel.gram[y >> 3][x] >> (y & 7)) & 1;
+  return on != panel.inverted;
+}
+
+bool native_panel_inverted()
+{
+  return panel.inverted;
+}
+
+uint32_t native_panel_bytes()
+{
+  return panel.bytes;
+}
+
+uint32_t native_panel_data_bytes()
+{
+  return panel.dataBytes;
+}
+
+uint32_t native_panel_writes()
+{
+  return panel.writes;
+}
+
+// Plain PBM (P1), lit pixel = 1
+void native_panel_write_pbm(FILE *f)
+{
+  fprintf(f, "P1\n%d %d\n", NATIVE_PANEL_W, NATIVE_PANEL_H);
+  for (uint8_t y = 0; y < NATIVE_PANEL_H; y++)
+  {
+    for (uint8_t x = 0; x < NATIVE_PANEL_W; x++)
+      fputc(native_panel_pixel(x, y) ? '1' : '0', f);
+    fputc('\n', f);
+  }
+}
@@ -0,0 +1,27 @@
+#pragma once
+// SSD1306 128x64 on the host: the real U8g2 driver, with the
+// bytes it would clock out over SPI fed to an emulated panel instead
+// (see native_panel_* in native_harness.h).
+#include <U8g2lib.h>
+#include "config.h"
+#include "native_harness.h"
+
+extern "C" uint8_t native_ssd1306_byte_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+extern "C" uint8_t native_gpio_and_delay_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+class NativeSsd1306 : public U8G2
+{
+public:
+  // Same arguments as U8G2_SSD1306_128X64_NONAME_F_4W_HW_SPI; pins unused.
+  // Buffer size follows UI_BUFFER_MODE like the firmware's display.
+  NativeSsd1306(const u8g2_cb_t *rotation, uint8_t cs, uint8_t dc, uint8_t reset = U8X8_PIN_NONE) : U8G2()
+  {
+#if UI_BUFFER_MODE == UI_BUFFER_PAGE1
+    u8g2_Setup_ssd1306_128x64_noname_1(&u8g2, rotation, native_ssd1306_byte_cb, native_gpio_and_delay_cb);
+#elif UI_BUFFER_MODE == UI_BUFFER_PAGE2
+    u8g2_Setup_ssd1306_128x64_noname_2(&u8g2, rotation, native_ssd1306_byte_cb, native_gpio_and_delay_cb);
+#else
+    u8g2_Setup_ssd1306_128x64_noname_f(&u8g2, rotation, native_ssd1306_byte_cb, native_gpio_and_delay_cb);
+#endif
+  }
+};
@@ -0,0 +1,85 @@
+// ATmega2560 EEPROM on the host: erased to 0xFF, each byte write keeps the
+// EEPROM busy for EEPROM_WRITE_US of virtual time, and like avr-libc any
+// access while busy waits it out (charged to the virtual clock).
+#include "Arduino.h"
+#include <avr/eeprom.h>
+#include "native_harness.h"
+
+#define EEPROM_SIZE (E2END + 1)
+#define EEPROM_WRITE_US 3300
+
+static uint8_t mem[EEPROM_SIZE];
+static bool erased = false;
+static uint64_t busyUntilUs = 0;
+static NativeEepromStats stats;
+
+static void ensure_erased()
+{
+  if (erased)
+    return;
+  memset(mem, 0xFF, sizeof(mem));
+  erased = true;
+}
+
+static void wait_ready()
+{
+  uint64_t now = native_clock_us();
+  if (now >= busyUntilUs)
+    return;
+  uint64_t wait = busyUntilUs - now;
+  stats.blockedUs += wait;
+  native_clock_advance_us((uint32_t)wait);
+}
+
+int native_eeprom_ready()
+{
+  return native_clock_us() >= busyUntilUs;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+  ensure_erased();
+  wait_ready();
+  return mem[(uintptr_t)addr % EEPROM_SIZE];
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr)
+{
+  const uint8_t *p = (const uint8_t *)addr;
+  return eeprom_read_byte(p) | (uint16_t)eeprom_read_byte(p + 1) << 8;
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+  ensure_erased();
+  wait_ready();
+  uintptr_t a = (uintptr_t)addr % EEPROM_SIZE;
+  mem[a] = value;
+  busyUntilUs = native_clock_us() + EEPROM_WRITE_US;
+  stats.writes++;
+  if (stats.maxCellWrites < ++stats.cellWrites[a])
+    stats.maxCellWrites = stats.cellWrites[a];
+}
+
+bool native_eeprom_load(FILE *f)
+{
+  ensure_erased();
+  return fread(mem, 1, sizeof(mem), f) == sizeof(mem);
+}
+
+bool native_eeprom_save(FILE *f)
+{
+  ensure_erased();
+  return fwrite(mem, 1, sizeof(mem), f) == sizeof(mem);
+}
+
+const NativeEepromStats &native_eeprom_stats()
+{
+  return stats;
+}
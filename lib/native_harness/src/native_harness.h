@@ -0,0 +1,68 @@
+#pragma once
+// Control surface of the host build: the harness (and later tools) drive
+// virtual time, inputs, the CAN bus and inspect the emulated panel here.
+#include <stdint.h>
+#include <stdio.h>
+
+// -------- clock --------
+uint64_t native_clock_us();
+void native_clock_advance_us(uint32_t us);
+
+// -------- GPIO --------
+// Drive an input pin from outside; fires attached interrupts on edges.
+void native_gpio_set(uint8_t pin, uint8_t level);
+uint8_t native_gpio_get(uint8_t pin);
+
+// -------- CAN (MCP2515) --------
+struct NativeCanStats
+{
+  uint32_t injected; // frames put on the bus
+  uint32_t filtered; // rejected by masks/filters
+  uint32_t overflow; // accepted but both RX buffers were full
+  uint32_t read;     // frames read by the firmware
+};
+
+void native_can_set_int_pin(uint8_t pin);
+// false if the controller did not take the frame (filtered or overflow)
+bool native_can_inject(uint32_t id, uint8_t len, const uint8_t *data);
+NativeCanStats native_can_stats();
+
+// -------- SSD1306 panel --------
+#define NATIVE_PANEL_W 128
+#define NATIVE_PANEL_H 64
+
+const uint8_t *native_panel_gram(); // 8 pages x 128 columns, LSB = top pixel
+bool native_panel_pixel(uint8_t x, uint8_t y);
+bool native_panel_inverted();
+uint32_t native_panel_bytes();      // all bytes sent to the panel
+uint32_t native_panel_data_bytes(); // display RAM writes only
+uint32_t native_panel_writes();     // number of completed transfers
+void native_panel_write_pbm(FILE *f);
+
+// -------- EEPROM --------
+struct NativeEepromStats
+{
+  uint32_t writes;        // byte writes
+  uint64_t blockedUs;     // time accesses spent waiting for a write to finish
+  uint16_t maxCellWrites; // most writes to any one byte
+  uint16_t cellWrites[4096];
+};
+
+// Raw 4 KB image, e.g. to carry the EEPROM across runs (power cycles)
+bool native_eeprom_load(FILE *f);
+bool native_eeprom_save(FILE *f);
+const NativeEepromStats &native_eeprom_stats();
+
+// -------- heap --------
+uint32_t native_heap_bytes(); // total requested through operator new
+
+// -------- Serial --------
+void native_serial_set_sink(FILE *f); // where Serial output goes (nullptr = drop)
+void native_serial_feed(const uint8_t *data, size_t len);
+
+struct NativeSerialStats
+{
+  uint32_t bytes;     // written by the firmware
+  uint64_t blockedUs; // write() waiting for room in the TX buffer
+};
+NativeSerialStats native_serial_stats();
@@ -0,0 +1,199 @@
+// Entry point of the native build: runs the unmodified setup()/loop() on
+// virtual time, either idle for --ms or driven by a CAN log (--replay).
+#include "Arduino.h"
+#include "native_harness.h"
+#include "replay.h"
+#include "pins.h"
+#include "bench/bench.h"
+
+void setup();
+void loop();
+
+static const char USAGE[] =
+    "usage: %s [--ms N] [--step-us N] [--pbm out.pbm] [--eeprom image]\n"
+    "          [--serial out] [--serial-in text]\n"
+    "          [--replay log] [--speed X | --afap] [--wall]\n"
+    "          [--timeline out.csv] [--frames dir] [--latency-sig name]\n"
+    "       %s --bench\n"
+    "  --replay    candump -l log or Vector ASC trace\n"
+    "  --speed     replay rate, 1 = as recorded (virtual time)\n"
+    "  --afap      ignore timestamps, one frame per loop pass\n"
+    "  --wall      pace virtual time to the host clock\n"
+    "  --timeline  CSV row per decoded VehicleState change\n"
+    "  --frames    write a PBM per changed panel frame\n"
+    "  --latency-sig  timeline column timed frame->pixel (default gear)\n"
+    "  --eeprom    4 KB EEPROM image, loaded before setup() and saved at exit\n"
+    "  --serial    Serial output to a file instead of stdout\n"
+    "  --serial-in bytes to send the firmware after setup(), e.g. T\n"
+    "  --bench     time decode, widgets and page builds, then exit\n";
+
+struct RunOptions
+{
+  uint32_t runMs = 5000;
+  uint32_t stepUs = 100; // virtual time charged per loop() pass
+  const char *pbmPath = nullptr;
+  const char *eepromPath = nullptr;
+  const char *serialPath = nullptr;
+  const char *serialIn = nullptr;
+  bool bench = false;
+  ReplayOptions replay;
+};
+
+static bool parse_args(int argc, char **argv, RunOptions &opt)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const char *a = argv[i];
+    const char *v = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--ms") && v)
+      opt.runMs = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--step-us") && v)
+      opt.stepUs = strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--pbm") && v)
+      opt.pbmPath = argv[++i];
+    else if (!strcmp(a, "--eeprom") && v)
+      opt.eepromPath = argv[++i];
+    else if (!strcmp(a, "--serial") && v)
+      opt.serialPath = argv[++i];
+    else if (!strcmp(a, "--serial-in") && v)
+      opt.serialIn = argv[++i];
+    else if (!strcmp(a, "--replay") && v)
+      opt.replay.logPath = argv[++i];
+    else if (!strcmp(a, "--speed") && v)
+      opt.replay.speed = strtod(argv[++i], nullptr);
+    else if (!strcmp(a, "--bench"))
+      opt.bench = true;
+    else if (!strcmp(a, "--afap"))
+      opt.replay.afap = true;
+    else if (!strcmp(a, "--wall"))
+      opt.replay.wall = true;
+    else if (!strcmp(a, "--timeline") && v)
+      opt.replay.timelinePath = argv[++i];
+    else if (!strcmp(a, "--frames") && v)
+      opt.replay.framesDir = argv[++i];
+    else if (!strcmp(a, "--latency-sig") && v)
+      opt.replay.latencySignal = argv[++i];
+    else
+    {
+      fprintf(stderr, USAGE, argv[0], argv[0]);
+      return false;
+    }
+  }
+  if (opt.replay.speed <= 0)
+  {
+    fprintf(stderr, "--speed must be > 0\n");
+    return false;
+  }
+  opt.replay.stepUs = opt.stepUs;
+  return true;
+}
+
+static int write_pbm(const char *path)
+{
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    perror(path);
+    return 1;
+  }
+  native_panel_write_pbm(f);
+  fclose(f);
+  return 0;
+}
+
+// A missing image is a blank EEPROM
+static void load_eeprom(const char *path)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return;
+  if (!native_eeprom_load(f))
+    fprintf(stderr, "%s: short EEPROM image\n", path);
+  fclose(f);
+}
+
+static int save_eeprom(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (!f || !native_eeprom_save(f))
+  {
+    perror(path);
+    if (f)
+      fclose(f);
+    return 1;
+  }
+  fclose(f);
+  const NativeEepromStats &st = native_eeprom_stats();
+  fprintf(stderr, "eeprom: %u byte writes, busiest byte %u, %llu us blocked\n",
+          st.writes, st.maxCellWrites, (unsigned long long)st.blockedUs);
+  return 0;
+}
+
+static int run(const RunOptions &opt)
+{
+  if (opt.bench)
+    return bench_run(Serial) ? 1 : 0;
+
+  if (opt.replay.logPath)
+  {
+    int rc = replay_run(opt.replay);
+    if (rc == 0 && opt.pbmPath)
+      rc = write_pbm(opt.pbmPath);
+    return rc;
+  }
+
+  uint64_t endUs = native_clock_us() + (uint64_t)opt.runMs * 1000;
+  uint32_t passes = 0;
+  while (native_clock_us() < endUs)
+  {
+    loop();
+    native_clock_advance_us(opt.stepUs);
+    passes++;
+  }
+
+  fprintf(stderr, "ran %u ms: %u loop passes, %u panel bytes in %u transfers\n",
+          opt.runMs, passes, native_panel_bytes(), native_panel_writes());
+
+  return opt.pbmPath ? write_pbm(opt.pbmPath) : 0;
+}
+
+// pio test links the firmware and this library into test/ programs with
+// their own main()
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char **argv)
+{
+  RunOptions opt;
+  if (!parse_args(argc, argv, opt))
+    return 2;
+
+  if (opt.eepromPath)
+    load_eeprom(opt.eepromPath);
+  FILE *serialOut = nullptr;
+  if (opt.serialPath)
+  {
+    serialOut = fopen(opt.serialPath, "wb");
+    if (!serialOut)
+    {
+      perror(opt.serialPath);
+      return 1;
+    }
+    native_serial_set_sink(serialOut);
+  }
+  native_can_set_int_pin(CAN_INT);
+  setup();
+  if (opt.serialIn)
+    native_serial_feed((const uint8_t *)opt.serialIn, strlen(opt.serialIn));
+
+  int rc = run(opt);
+  if (opt.eepromPath && save_eeprom(opt.eepromPath))
+    rc = 1;
+  if (serialOut)
+  {
+    NativeSerialStats st = native_serial_stats();
+    fprintf(stderr, "serial: %u bytes, %llu us blocked in write()\n", st.bytes, (unsigned long long)st.blockedUs);
+    native_serial_set_sink(nullptr);
+    fclose(serialOut);
+  }
+  return rc;
+}
+#endif
@@ -0,0 +1,234 @@
+#include "replay.h"
+#include "can_log.h"
+#include "native_harness.h"
+#include "config.h"
+#include "types.h"
+#include "can/canbus.h"
+#include "vehicle/vehicle.h"
+#include "shift/shift.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <unistd.h>
+
+void loop();
+extern VehicleState vehicle;
+
+static const char *const SIGNAL_NAMES[] = {
+    "rpm", "map_kpa", "lambda_x1000", "tps", "clt", "iat", "oilp_x10", "speed_x10",
+    "odo", "trip", "gear", "prnd", "drive_mode"};
+static_assert(sizeof(SIGNAL_NAMES) / sizeof(SIGNAL_NAMES[0]) == SIG_COUNT, "SIGNAL_NAMES out of sync with SignalId");
+
+// Nominal bits on the wire incl. ~10% stuffing and interframe space
+static uint32_t frame_bits(const LoggedFrame &f)
+{
+  uint32_t bits = ((f.id & 0x80000000UL) ? 64 : 44) + 8 * f.len;
+  return bits + bits / 10 + 3;
+}
+
+static void write_timeline_header(FILE *f)
+{
+  fprintf(f, "t_us,frames");
+  for (uint8_t s = 0; s < SIG_COUNT; s++)
+    fprintf(f, ",%s", SIGNAL_NAMES[s]);
+  fputc('\n', f);
+}
+
+static void write_timeline_row(FILE *f, uint64_t tUs, uint32_t frames)
+{
+  fprintf(f, "%llu,%u", (unsigned long long)tUs, frames);
+  for (uint8_t s = 0; s < SIG_COUNT; s++)
+    fprintf(f, ",%ld", (long)vehicle_get(vehicle, (SignalId)s));
+  fputc('\n', f);
+}
+
+static void write_frame(const char *dir, uint32_t index, uint64_t tUs)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%06u_%llu.pbm", dir, index, (unsigned long long)tUs);
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    perror(path);
+    return;
+  }
+  native_panel_write_pbm(f);
+  fclose(f);
+}
+
+static void print_latency(const char *what, const std::vector<uint32_t> &lat)
+{
+  if (lat.empty())
+  {
+    fprintf(stderr, "%s latency: no displayed changes\n", what);
+    return;
+  }
+  std::vector<uint32_t> s(lat);
+  std::sort(s.begin(), s.end());
+  uint64_t sum = 0;
+  for (uint32_t v : s)
+    sum += v;
+  fprintf(stderr, "%s latency (%zu samples): min %u us, avg %llu us, p99 %u us, max %u us\n",
+          what, s.size(), s.front(), (unsigned long long)(sum / s.size()), s[s.size() * 99 / 100], s.back());
+}
+
+int replay_run(const ReplayOptions &opt)
+{
+  std::vector<LoggedFrame> frames;
+  if (!can_log_load(opt.logPath, frames))
+  {
+    perror(opt.logPath);
+    return 1;
+  }
+  if (frames.empty())
+  {
+    fprintf(stderr, "%s: no CAN frames found\n", opt.logPath);
+    return 1;
+  }
+
+  FILE *timeline = nullptr;
+  if (opt.timelinePath)
+  {
+    timeline = fopen(opt.timelinePath, "w");
+    if (!timeline)
+    {
+      perror(opt.timelinePath);
+      return 1;
+    }
+    write_timeline_header(timeline);
+  }
+
+  // Let the splash screen finish so latency is measured on live pages
+  uint64_t t0 = native_clock_us() + (uint64_t)SPLASH_MS * 1000;
+  while (native_clock_us() < t0)
+  {
+    loop();
+    native_clock_advance_us(opt.stepUs);
+  }
+
+  // Latency is timed for one field that the current page shows: from the
+  // injection of the frame that changed it to the first panel write after.
+  int latencySig = -1;
+  for (uint8_t sig = 0; sig < SIG_COUNT; sig++)
+    if (!strcmp(opt.latencySignal, SIGNAL_NAMES[sig]))
+      latencySig = sig;
+  if (latencySig < 0)
+  {
+    fprintf(stderr, "unknown latency signal '%s'\n", opt.latencySignal);
+    return 1;
+  }
+
+  std::deque<uint64_t> inFlight; // injection time of accepted, undecoded frames
+  std::vector<uint32_t> latency;
+  std::vector<uint32_t> shiftLatency; // frame that crossed the shift point -> panel inverted
+  bool lastShift = shift_active();
+  std::vector<uint8_t> lastGram(native_panel_gram(), native_panel_gram() + 1024);
+  VehicleState lastVehicle = vehicle;
+  uint64_t changeSinceUs = 0; // oldest decoded change not yet on the panel
+  uint64_t bits = 0;
+  uint32_t lastDecoded = 0;
+  uint32_t framesOut = 0;
+  size_t next = 0;
+  uint64_t drainUntil = 0;
+
+  while (true)
+  {
+    uint64_t now = native_clock_us() - t0;
+
+    // Put due frames on the bus
+    if (opt.afap)
+    {
+      if (next < frames.size())
+      {
+        const LoggedFrame &f = frames[next++];
+        if (native_can_inject(f.id, f.len, f.data))
+          inFlight.push_back(now);
+        bits += frame_bits(f);
+      }
+    }
+    else
+    {
+      while (next < frames.size() && frames[next].tUs / opt.speed <= now)
+      {
+        const LoggedFrame &f = frames[next++];
+        if (native_can_inject(f.id, f.len, f.data))
+          inFlight.push_back(now);
+        bits += frame_bits(f);
+      }
+    }
+
+    loop();
+
+    // Frames decoded this pass: read from the MCP2515 (by the ISR, possibly
+    // during injection) minus those still waiting in the ring
+    CanRxStats ring = can_rx_stats();
+    uint32_t decoded = native_can_stats().read - ring.dropped - ring.pending;
+    uint32_t consumed = decoded - lastDecoded;
+    lastDecoded = decoded;
+    uint64_t oldest = 0;
+    for (uint32_t i = 0; i < consumed && !inFlight.empty(); i++)
+    {
+      if (i == 0)
+        oldest = inFlight.front();
+      inFlight.pop_front();
+    }
+
+    SignalMask changed = vehicle_diff(vehicle, lastVehicle);
+    if (changed)
+    {
+      lastVehicle = vehicle;
+      if (timeline)
+        write_timeline_row(timeline, now, consumed);
+      if (!changeSinceUs && consumed && (changed & SIG_BIT(latencySig)))
+        changeSinceUs = oldest + 1; // +1 keeps t=0 distinguishable from "none"
+    }
+
+    bool shift = shift_active();
+    if (shift && !lastShift && consumed && native_panel_inverted())
+      shiftLatency.push_back((uint32_t)(now - oldest));
+    lastShift = shift;
+
+    const uint8_t *gram = native_panel_gram();
+    if (memcmp(gram, lastGram.data(), lastGram.size()) != 0)
+    {
+      lastGram.assign(gram, gram + 1024);
+      if (changeSinceUs)
+        latency.push_back((uint32_t)(now - (changeSinceUs - 1)));
+      changeSinceUs = 0;
+      if (opt.framesDir)
+        write_frame(opt.framesDir, framesOut, now);
+      framesOut++;
+    }
+    else if (changeSinceUs && now - (changeSinceUs - 1) > 1000000)
+    {
+      changeSinceUs = 0; // not on the current page after all
+    }
+
+    native_clock_advance_us(opt.stepUs);
+    if (opt.wall)
+      usleep(opt.stepUs);
+
+    if (next >= frames.size())
+    {
+      if (!drainUntil)
+        drainUntil = now + 200000;
+      else if (now >= drainUntil)
+        break;
+    }
+  }
+
+  if (timeline)
+    fclose(timeline);
+
+  uint64_t spanUs = native_clock_us() - t0;
+  NativeCanStats bus = native_can_stats();
+  CanRxStats ring = can_rx_stats();
+  fprintf(stderr, "replayed %zu frames in %.3f s virtual (%.0f frames/s, %.1f%% of 500 kbps)\n",
+          frames.size(), spanUs / 1e6, frames.size() * 1e6 / spanUs, bits * 100.0 / (spanUs * 0.5));
+  fprintf(stderr, "mcp2515: %u filtered, %u overflow, %u read; ring: %u dropped, high water %u/%u\n",
+          bus.filtered, bus.overflow, bus.read, ring.dropped, ring.highWater, CAN_RX_RING_SIZE);
+  fprintf(stderr, "panel: %u frames, %u bytes\n", framesOut, native_panel_bytes());
+  print_latency("frame->pixel", latency);
+  print_latency("rpm->shift light", shiftLatency);
+  return 0;
+}
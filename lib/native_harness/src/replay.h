@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+
+struct ReplayOptions
+{
+  const char *logPath = nullptr;
+  double speed = 1.0;              // log time / virtual time
+  bool afap = false;               // ignore timestamps: one frame per loop pass
+  bool wall = false;               // pace virtual time to the host clock
+  uint32_t stepUs = 100;           // virtual time charged per loop() pass
+  const char *timelinePath = nullptr; // CSV of decoded VehicleState changes
+  const char *framesDir = nullptr;    // PBM per changed panel frame
+  const char *latencySignal = "gear"; // field timed frame->pixel; must be on screen
+};
+
+// Feed a recorded bus log through the emulated MCP2515 into the running
+// firmware. Call after setup(). Returns a process exit code.
+int replay_run(const ReplayOptions &opt);
@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include "alarm.h"
+#include "vehicle/vehicle.h"
+
+enum : uint8_t
+{
+  ALARM_ABOVE = 0,      // past = value > threshold
+  ALARM_BELOW = 1 << 0, // past = value < threshold
+};
+
+struct AlarmRule
+{
+  SignalId sig;
+  uint8_t flags;
+  int16_t threshold;
+  int16_t hysteresis;  // back past threshold by this much to clear
+  uint16_t debounceMs; // must hold this long to raise
+  uint8_t priority;    // 0 = most urgent
+  SignalId gateSig;    // SIG_COUNT = no gate
+  uint8_t gateFlags;
+  int16_t gateThreshold;
+  const char *text;
+};
+
+#define NO_GATE SIG_COUNT, 0, 0
+
+static const AlarmRule ALARM_RULES[] PROGMEM = {
+    //  sig         flags        thr   hyst debounce prio gate                          text
+    {SIG_OILP,   ALARM_BELOW, 8,    3,   500,     0,   SIG_RPM, ALARM_ABOVE, 400,    "OIL PRESSURE"},
+    {SIG_CLT,    ALARM_ABOVE, 110,  3,   2000,    1,   NO_GATE,                      "COOLANT HOT"},
+    {SIG_LAMBDA, ALARM_ABOVE, 1080, 20,  300,     1,   SIG_MAP, ALARM_ABOVE, 120,    "LEAN ON BOOST"},
+    {SIG_RPM,    ALARM_ABOVE, 7200, 200, 0,       2,   NO_GATE,                      "OVER REV"},
+    {SIG_IAT,    ALARM_ABOVE, 60,   3,   5000,    3,   NO_GATE,                      "INTAKE HOT"},
+};
+
+static const uint8_t ALARM_RULE_COUNT = sizeof(ALARM_RULES) / sizeof(ALARM_RULES[0]);
+
+// One bit per rule
+typedef uint32_t RuleMask;
+#define RULE_BIT(i) ((RuleMask)1 << (i))
+static_assert(ALARM_RULE_COUNT <= 32, "ALARM_RULES: at most 32 rules");
+
+static RuleMask rulesBySignal[SIG_COUNT]; // rules reading each signal
+static RuleMask tripped = 0;              // condition holds
+static RuleMask pending = 0;              // tripped, debounce running
+static RuleMask raised = 0;
+static RuleMask acked = 0;
+static uint32_t trippedAtMs[ALARM_RULE_COUNT];
+
+static void read_rule(uint8_t i, AlarmRule &r)
+{
+  memcpy_P(&r, &ALARM_RULES[i], sizeof(r));
+}
+
+void alarm_init()
+{
+  memset(rulesBySignal, 0, sizeof(rulesBySignal));
+  for (uint8_t i = 0; i < ALARM_RULE_COUNT; i++)
+  {
+    AlarmRule r;
+    read_rule(i, r);
+    rulesBySignal[r.sig] |= RULE_BIT(i);
+    if (r.gateSig < SIG_COUNT)
+      rulesBySignal[r.gateSig] |= RULE_BIT(i);
+  }
+  tripped = pending = raised = acked = 0;
+}
+
+static bool past(int32_t value, uint8_t flags, int32_t limit)
+{
+  return (flags & ALARM_BELOW) ? value < limit : value > limit;
+}
+
+static void alarm_eval(uint8_t i, const VehicleState &vehicle, uint32_t nowMs)
+{
+  AlarmRule r;
+  read_rule(i, r);
+  RuleMask bit = RULE_BIT(i);
+  bool was = tripped & bit;
+
+  // Once tripped, the limit moves back by the hysteresis
+  int32_t limit = r.threshold;
+  if (was)
+    limit += (r.flags & ALARM_BELOW) ? r.hysteresis : -r.hysteresis;
+
+  bool now = past(vehicle_get(vehicle, r.sig), r.flags, limit);
+  if (now && r.gateSig < SIG_COUNT)
+    now = past(vehicle_get(vehicle, r.gateSig), r.gateFlags, r.gateThreshold);
+  if (now == was)
+    return;
+
+  if (now)
+  {
+    tripped |= bit;
+    pending |= bit;
+    trippedAtMs[i] = nowMs;
+  }
+  else
+  {
+    tripped &= ~bit;
+    pending &= ~bit;
+    raised &= ~bit;
+    acked &= ~bit;
+  }
+}
+
+void alarm_update(SignalMask changed, const VehicleState &vehicle, uint32_t nowMs)
+{
+  RuleMask todo = 0;
+  for (uint8_t s = 0; changed; s++, changed >>= 1)
+    if (changed & 1)
+      todo |= rulesBySignal[s];
+
+  for (uint8_t i = 0; todo; i++, todo >>= 1)
+    if (todo & 1)
+      alarm_eval(i, vehicle, nowMs);
+
+  RuleMask wait = pending;
+  for (uint8_t i = 0; wait; i++, wait >>= 1)
+  {
+    if (!(wait & 1))
+      continue;
+    if (nowMs - trippedAtMs[i] >= pgm_read_word(&ALARM_RULES[i].debounceMs))
+    {
+      pending &= ~RULE_BIT(i);
+      raised |= RULE_BIT(i);
+    }
+  }
+}
+
+uint8_t alarm_top()
+{
+  RuleMask show = raised & ~acked;
+  uint8_t top = ALARM_NONE;
+  uint8_t topPriority = 0xFF;
+  for (uint8_t i = 0; show; i++, show >>= 1)
+  {
+    if (!(show & 1))
+      continue;
+    uint8_t p = pgm_read_byte(&ALARM_RULES[i].priority);
+    if (p < topPriority)
+    {
+      top = i;
+      topPriority = p;
+    }
+  }
+  return top;
+}
+
+void alarm_ack(uint8_t rule)
+{
+  if (rule < ALARM_RULE_COUNT)
+    acked |= RULE_BIT(rule) & raised;
+}
+
+uint8_t alarm_count()
+{
+  return ALARM_RULE_COUNT;
+}
+
+const char *alarm_text(uint8_t rule)
+{
+  return (const char *)pgm_read_ptr(&ALARM_RULES[rule].text);
+}
+
+SignalId alarm_signal(uint8_t rule)
+{
+  return (SignalId)pgm_read_byte(&ALARM_RULES[rule].sig);
+}
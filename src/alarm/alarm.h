@@ -0,0 +1,30 @@
+#pragma once
+#include "types.h"
+
+// -------- Alarms --------
+// Table driven (alarm.cpp): each rule compares one signal against a
+// threshold, optionally only while a second "gate" signal is past its own
+// limit, e.g. lean lambda only under boost. Rules are evaluated only when
+// one of their signals changes; a per-signal index of rules makes that
+// O(rules on the changed signals) rather than a scan of the table.
+//
+// A rule trips when its condition holds, and is raised once it has held
+// for its debounce time. It clears when the value is back past the
+// threshold by the hysteresis (or the gate closes). Acknowledging the
+// raised alarm hides it until it clears and raises again.
+
+#define ALARM_NONE 0xFF
+
+void alarm_init();
+
+// Evaluate the rules on the changed signals, then raise tripped rules whose
+// debounce time is over. Call after decoding.
+void alarm_update(SignalMask changed, const VehicleState &vehicle, uint32_t nowMs);
+
+// Raised, unacknowledged rule with the most urgent priority, or ALARM_NONE
+uint8_t alarm_top();
+void alarm_ack(uint8_t rule);
+
+uint8_t alarm_count(); // rules in the table
+const char *alarm_text(uint8_t rule);
+SignalId alarm_signal(uint8_t rule);
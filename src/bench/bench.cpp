@@ -0,0 +1,355 @@
+// Built for env:bench_avr and the host only, so the Timer1 ISR stays out
+// of the normal firmware
+#if defined(BENCH) || defined(NATIVE)
+
+#include "bench.h"
+#include <U8g2lib.h>
+#include "config.h"
+#include "types.h"
+#include "ui/ui.h"
+#include "ui/pages/page_main.h"
+#include "can/canbus.h"
+#include "can/can_decode.h"
+#include "history/history.h"
+#include "stats/stats.h"
+#include "alarm/alarm.h"
+#include "vehicle/vehicle.h"
+#include "vehicle/odometer.h"
+#include "telemetry/telemetry.h"
+#include "can/slcan.h"
+
+#ifdef NATIVE
+#include <time.h>
+#include <native_harness.h>
+#endif
+
+// Native iterations per AVR iteration: host timers need longer runs
+#define BENCH_NATIVE_SCALE 200
+
+typedef void (*BenchFn)(uint16_t i);
+
+struct BenchCase
+{
+  const char *name;
+  BenchFn fn;
+  uint16_t iters;       // on AVR
+  uint32_t budgetCycles; // AVR cycles/op; 0 = report only
+};
+
+static VehicleState benchVehicle;
+
+// -------- Clock --------
+#ifdef __AVR__
+// Timer1 free-running at F_CPU; overflows extend it to 32 bits
+static volatile uint16_t t1Overflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+  t1Overflows++;
+}
+
+static void bench_clock_start()
+{
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TCNT1 = 0;
+  t1Overflows = 0;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 = _BV(TOIE1);
+}
+
+static void bench_clock_stop()
+{
+  TIMSK1 = 0;
+  TCCR1B = 0;
+}
+
+static uint32_t bench_now()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t lo = TCNT1;
+  uint16_t hi = t1Overflows;
+  // Overflow pending but not serviced yet
+  if ((TIFR1 & _BV(TOV1)) && lo < 0x8000)
+    hi++;
+  SREG = sreg;
+  return ((uint32_t)hi << 16) | lo;
+}
+
+static uint32_t bench_heap_top()
+{
+  extern char __heap_start;
+  extern char *__brkval;
+  return (uint16_t)(__brkval ? __brkval : &__heap_start);
+}
+#else
+static void bench_clock_start() {}
+static void bench_clock_stop() {}
+
+// ns
+static uint32_t bench_now()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+static uint32_t bench_heap_top()
+{
+  return native_heap_bytes();
+}
+#endif
+
+// -------- Cases --------
+#define BENCH_FRAMES 8
+static CanFrame benchFrames[BENCH_FRAMES];
+static uint8_t benchFrameCount = 0;
+
+// One frame per table id, payload varied per iteration
+static void bench_decode(uint16_t i)
+{
+  CanFrame &f = benchFrames[i % benchFrameCount];
+  f.data[0] = i;
+  f.data[1] = i >> 8;
+  can_decode_frame(f, benchVehicle);
+}
+
+// Its share of decode: one call per decoded signal
+static void bench_stats_update(uint16_t i)
+{
+  stats_update((SignalId)(i % STATS_COUNT), (int16_t)(i * 97));
+}
+
+// Its share of decoding a speed frame, 20 ms apart
+static void bench_odo_sample(uint16_t i)
+{
+  odometer_sample(benchVehicle, 1200 + (i & 0xFF), i * 20);
+}
+
+// After a decode batch that changed one signal
+static void bench_alarm_update(uint16_t i)
+{
+  SignalId sig = (SignalId)(i % STATS_COUNT);
+  vehicle_set(benchVehicle, sig, (int16_t)(i * 97));
+  alarm_update(SIG_BIT(sig), benchVehicle, i);
+}
+
+// One delta frame with three fields changed
+static void bench_telemetry(uint16_t i)
+{
+  benchVehicle.rpm = i * 7;
+  benchVehicle.tps = i;
+  benchVehicle.map_kpa = i * 3;
+  telemetry_build_frame(benchVehicle, i * 10UL);
+}
+
+// Bridge mode, once per frame on the bus: 8 data bytes to ASCII
+static void bench_slcan_frame(uint16_t i)
+{
+  static uint8_t out[SLCAN_ASCII_MAX];
+  CanFrame &f = benchFrames[i % benchFrameCount];
+  f.data[7] = i;
+  slcan_encode(f, out);
+}
+
+static void bench_prnd(uint16_t i)
+{
+  drawPRND(ui_display(), (Prnd)(i & 3), 5, 48, i & 4);
+}
+
+static void bench_gear(uint16_t i)
+{
+  drawActualGear(ui_display(), (int)(i % 8) - 1, 41);
+}
+
+static void bench_odometer(uint16_t i)
+{
+  drawOdometerCentered(ui_display(), 423911UL + i, 18);
+}
+
+static void bench_drive_mode(uint16_t i)
+{
+  benchVehicle.driveMode = (DriveMode)(i & 3);
+  drawDriveMode(ui_display(), benchVehicle, 96, 44, false);
+}
+
+static void bench_progress_bar(uint16_t i)
+{
+  drawProgressBarWithInvertedText(0, 52, 128, 11, i % 9000, 0, 9000, "RPM 4500");
+  ui_display().setMaxClipWindow();
+}
+
+static void bench_lambda_line(uint16_t i)
+{
+  drawLambdaLine(0, 15, 128, 11, 700 + i % 540, 700, 1240);
+}
+
+static PageId benchPage = PAGE_MAIN;
+
+static void bench_page(uint16_t i)
+{
+  ui_show_page(benchPage); // whole page every time, no chart scrolling
+  benchVehicle.rpm = i % 9000;
+  benchVehicle.gear = i % 8 - 1;
+  draw_current_page(benchVehicle);
+}
+
+static void bench_chart_sample(uint16_t i)
+{
+  benchVehicle.lambda = 800 + (i * 37) % 400;
+  history_sample(benchVehicle);
+}
+
+// The chart page as it runs: one new sample per frame
+static void bench_chart_scroll(uint16_t i)
+{
+  bench_chart_sample(i);
+  draw_current_page(benchVehicle);
+}
+
+// Budgets are cycles/op at 16 MHz with some headroom over a reference
+// run; tighten them when a change makes a case cheaper.
+static const BenchCase CASES[] = {
+    //  name          fn                  iters budget
+    {"decode",       bench_decode,       200, 1500},
+    {"stats_update", bench_stats_update, 200, 150},
+    {"odo_sample",   bench_odo_sample,   200, 120},
+    {"alarm_update", bench_alarm_update, 200, 1500},
+    {"telemetry",    bench_telemetry,    200, 5000},
+    {"slcan_frame",  bench_slcan_frame,  200, 2500},
+    {"prnd",         bench_prnd,         50,  40000},
+    {"gear",         bench_gear,         50,  30000},
+    {"odometer",     bench_odometer,     50,  30000},
+    {"drive_mode",   bench_drive_mode,   50,  20000},
+    {"progress_bar", bench_progress_bar, 50,  40000},
+    {"lambda_line",  bench_lambda_line,  50,  10000},
+};
+
+static const char *const PAGE_NAMES[] = {"page_main", "page_sensors", "page_fuel", "page_boost", "page_chart", "page_stats", "page_debug"};
+static_assert(sizeof(PAGE_NAMES) / sizeof(PAGE_NAMES[0]) == PAGE_COUNT, "PAGE_NAMES must match PageId");
+
+// Full page builds, same order as PageId
+static const uint32_t PAGE_BUDGETS[PAGE_COUNT] = {160000, 120000, 60000, 120000, 80000, 100000, 120000};
+#define CHART_SCROLL_BUDGET 40000
+#define BENCH_PAGE_ITERS 10
+
+// -------- Runner --------
+static void print_col(Print &out, uint32_t v, uint8_t width)
+{
+  uint32_t digits = 1;
+  for (uint32_t t = v; t >= 10; t /= 10)
+    digits++;
+  while (digits++ < width)
+    out.print(' ');
+  out.print(v);
+}
+
+static void print_name(Print &out, const char *name)
+{
+  out.print(name);
+  for (uint8_t n = strlen(name); n < 14; n++)
+    out.print(' ');
+}
+
+// Mean cost per op, and heap growth over the run
+static uint32_t bench_time(BenchFn fn, uint32_t iters, uint32_t &heapBytes)
+{
+  uint32_t heap0 = bench_heap_top();
+  uint32_t t0 = bench_now();
+  for (uint32_t i = 0; i < iters; i++)
+    fn((uint16_t)i);
+  uint32_t t1 = bench_now();
+  heapBytes = bench_heap_top() - heap0;
+  return (t1 - t0) / iters;
+}
+
+static bool bench_case(Print &out, const char *name, BenchFn fn, uint16_t iters, uint32_t budget)
+{
+#ifdef __AVR__
+  uint32_t n = iters;
+#else
+  uint32_t n = (uint32_t)iters * BENCH_NATIVE_SCALE;
+#endif
+  uint32_t heap;
+  uint32_t perOp = bench_time(fn, n, heap);
+
+  print_name(out, name);
+  print_col(out, n, 7);
+  print_col(out, perOp, 10);
+  print_col(out, heap, 7);
+#ifdef __AVR__
+  print_col(out, perOp / (F_CPU / 1000000UL), 8);
+  if (budget && perOp > budget)
+  {
+    out.print("  OVER ");
+    out.println(budget);
+    return false;
+  }
+#else
+  (void)budget;
+#endif
+  out.println();
+  return true;
+}
+
+uint8_t bench_run(Print &out)
+{
+  benchFrameCount = 0;
+  uint16_t ids[BENCH_FRAMES];
+  uint8_t n = can_decode_ids(ids, BENCH_FRAMES);
+  for (uint8_t k = 0; k < n; k++)
+  {
+    CanFrame &f = benchFrames[benchFrameCount++];
+    f.id = ids[k];
+    f.len = 8;
+    memset(f.data, 0, sizeof(f.data));
+  }
+
+#ifdef __AVR__
+  out.println("bench           iters  cycles/op heap B   us/op");
+#else
+  out.println("bench           iters      ns/op heap B");
+#endif
+
+  // SRAM side of the buffer mode tradeoff (UI_BUFFER_MODE)
+  out.print("frame buffer ");
+  out.print(ui_display().getBufferTileHeight() * 128);
+  out.println(" B");
+
+  uint8_t over = 0;
+  bench_clock_start();
+  for (uint8_t c = 0; c < sizeof(CASES) / sizeof(CASES[0]); c++)
+  {
+    const BenchCase &bc = CASES[c];
+    if ((bc.fn == bench_decode || bc.fn == bench_slcan_frame) && benchFrameCount == 0)
+      continue;
+    if (!bench_case(out, bc.name, bc.fn, bc.iters, bc.budgetCycles))
+      over++;
+  }
+
+  // draw_current_page() draws whichever page is current: step through all
+  // (once per band with a page buffer; budgets are for a full buffer)
+  uint8_t bands = 8 / ui_display().getBufferTileHeight();
+  for (uint8_t i = 0; i < HISTORY_LEN; i++)
+    bench_chart_sample(i);
+  for (uint8_t p = 0; p < PAGE_COUNT; p++)
+  {
+    benchPage = (PageId)p;
+    if (!bench_case(out, PAGE_NAMES[p], bench_page, BENCH_PAGE_ITERS, PAGE_BUDGETS[p] * bands))
+      over++;
+  }
+
+  ui_show_page(PAGE_CHART);
+  draw_current_page(benchVehicle);
+  if (!bench_case(out, "chart_scroll", bench_chart_scroll, BENCH_PAGE_ITERS, CHART_SCROLL_BUDGET * bands))
+    over++;
+  ui_show_page(PAGE_MAIN);
+  bench_clock_stop();
+
+  out.print("bench done, over budget: ");
+  out.println(over);
+  return over;
+}
+
+#endif // BENCH || NATIVE
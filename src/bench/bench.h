@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+// -------- Benchmarks --------
+// Times the hot paths (CAN decode, main page widgets, sensor page bars,
+// whole page builds) and prints one row per case.
+//  - native: ns/op from the host clock, heap bytes from operator new
+//    (.pio/build/native/program --bench)
+//  - AVR: Timer1 cycles/op, heap growth from __brkval, checked against a
+//    per-case cycle budget (env:bench_avr, see platformio.ini)
+// Returns the number of cases over budget (always 0 on native).
+uint8_t bench_run(Print &out);
@@ -0,0 +1,167 @@
+#include <Arduino.h>
+#include "can_decode.h"
+#include "vehicle/vehicle.h"
+#include "stats/stats.h"
+#include "vehicle/stale.h"
+#include "vehicle/odometer.h"
+
+// -------- Signal table --------
+// One entry per signal, sorted by CAN id (checked at compile time) so lookup
+// is a binary search over PROGMEM. Scaling is integer only:
+//   value = ((raw * mul) >> shift) + offset
+// so pick target units (e.g. 1/1000 lambda) that keep it exact enough.
+
+enum : uint8_t
+{
+  CAN_LE = 0,          // Intel: startBit is the LSB
+  CAN_BE = 1 << 0,     // Motorola: startBit is the MSB (DBC numbering)
+  CAN_SIGNED = 1 << 1, // two's complement
+};
+
+struct CanSignal
+{
+  uint16_t id;
+  uint8_t startBit;
+  uint8_t length; // bits, spanning at most 4 bytes
+  uint8_t flags;
+  uint8_t minLen; // DLC needed to hold the signal
+  SignalId target;
+  uint8_t shift;
+  int16_t mul;
+  int16_t offset;
+};
+
+// Index of the last byte a signal touches
+static constexpr uint8_t can_sig_last_byte(uint8_t start, uint8_t length, uint8_t flags)
+{
+  return (flags & CAN_BE)
+             ? (start >> 3) + (length > (start & 7) + 1 ? (length - (start & 7) - 1 + 7) >> 3 : 0)
+             : (start + length - 1) >> 3;
+}
+
+#define CAN_SIG(id, start, length, flags, mul, shift, offset, target) \
+  { id, start, length, flags, (uint8_t)(can_sig_last_byte(start, length, flags) + 1), target, shift, mul, offset }
+
+static constexpr CanSignal CAN_SIGNALS[] PROGMEM = {
+    // TODO: Replace these with *real* EMU Black IDs and scaling.
+    //      id     start len flags                mul shift off target
+    CAN_SIG(0x100, 0,    16, CAN_LE,              1,  0,    0,  SIG_RPM),
+    CAN_SIG(0x101, 0,    8,  CAN_LE | CAN_SIGNED, 1,  0,    0,  SIG_GEAR),
+    CAN_SIG(0x102, 0,    8,  CAN_LE,              1,  0,    0,  SIG_TPS),
+    CAN_SIG(0x103, 0,    8,  CAN_LE | CAN_SIGNED, 1,  0,    0,  SIG_CLT),
+    CAN_SIG(0x104, 0,    8,  CAN_LE | CAN_SIGNED, 1,  0,    0,  SIG_IAT),
+    CAN_SIG(0x105, 0,    16, CAN_LE,              1,  0,    0,  SIG_MAP),
+    CAN_SIG(0x106, 0,    8,  CAN_LE,              125, 4,   0,  SIG_LAMBDA), // raw/128 -> 1/1000
+    CAN_SIG(0x107, 0,    8,  CAN_LE,              10, 4,    0,  SIG_OILP),   // raw/16 bar -> 1/10
+    CAN_SIG(0x108, 0,    16, CAN_LE,              1,  0,    0,  SIG_SPEED),  // 1/10 km/h
+};
+
+static const uint8_t CAN_SIGNAL_COUNT = sizeof(CAN_SIGNALS) / sizeof(CAN_SIGNALS[0]);
+
+static constexpr bool can_table_valid(uint8_t i)
+{
+  return i >= CAN_SIGNAL_COUNT ||
+         (CAN_SIGNALS[i].length >= 1 && CAN_SIGNALS[i].length <= 32 &&
+          CAN_SIGNALS[i].minLen <= 8 &&
+          CAN_SIGNALS[i].minLen - (CAN_SIGNALS[i].startBit >> 3) <= 4 &&
+          CAN_SIGNALS[i].target < SIG_COUNT &&
+          (i == 0 || CAN_SIGNALS[i - 1].id <= CAN_SIGNALS[i].id) &&
+          can_table_valid(i + 1));
+}
+static_assert(can_table_valid(0), "CAN_SIGNALS: entries must be sorted by id, <= 4 bytes wide and within 8 bytes");
+
+// -------- Decoding --------
+
+static uint32_t can_extract(const uint8_t *data, const CanSignal &s)
+{
+  uint8_t first = s.startBit >> 3;
+  uint8_t last = s.minLen - 1;
+  uint32_t raw = 0;
+
+  if (s.flags & CAN_BE)
+  {
+    for (uint8_t i = first; i <= last; i++)
+      raw = (raw << 8) | data[i];
+    // MSB sits at bit (startBit & 7) of the first byte
+    uint8_t top = (last - first) * 8 + (s.startBit & 7) + 1;
+    raw >>= top - s.length;
+  }
+  else
+  {
+    for (uint8_t i = last + 1; i-- > first;)
+      raw = (raw << 8) | data[i];
+    raw >>= s.startBit & 7;
+  }
+
+  if (s.length < 32)
+    raw &= ((uint32_t)1 << s.length) - 1;
+  return raw;
+}
+
+static int32_t can_scale(uint32_t raw, const CanSignal &s)
+{
+  int32_t v = (int32_t)raw;
+  if ((s.flags & CAN_SIGNED) && s.length < 32 && (raw & ((uint32_t)1 << (s.length - 1))))
+    v = (int32_t)(raw | ~(((uint32_t)1 << s.length) - 1));
+
+  if (s.mul != 1)
+    v *= s.mul;
+  if (s.shift)
+    v >>= s.shift;
+  return v + s.offset;
+}
+
+// First table index with id >= canId
+static uint8_t can_lower_bound(uint16_t canId)
+{
+  uint8_t lo = 0, hi = CAN_SIGNAL_COUNT;
+  while (lo < hi)
+  {
+    uint8_t mid = (lo + hi) >> 1;
+    if (pgm_read_word(&CAN_SIGNALS[mid].id) < canId)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+SignalMask can_decode_frame(const CanFrame &frame, VehicleState &vehicle)
+{
+  // Extended frames (bit 31 set by mcp_can) never match 11-bit table ids
+  if (frame.id > 0x7FF)
+    return 0;
+
+  SignalMask changed = 0;
+  for (uint8_t i = can_lower_bound(frame.id); i < CAN_SIGNAL_COUNT; i++)
+  {
+    CanSignal s;
+    memcpy_P(&s, &CAN_SIGNALS[i], sizeof(s));
+    if (s.id != frame.id)
+      break;
+    if (frame.len < s.minLen)
+      continue;
+
+    int32_t value = can_scale(can_extract(frame.data, s), s);
+    if (vehicle_set(vehicle, s.target, value))
+      changed |= SIG_BIT(s.target);
+    // Every sample, changed or not
+    stats_update(s.target, value);
+    stale_note(s.target);
+    if (s.target == SIG_SPEED)
+      changed |= odometer_sample(vehicle, value, frame.tMs);
+  }
+  return changed;
+}
+
+uint8_t can_decode_ids(uint16_t *ids, uint8_t max)
+{
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < CAN_SIGNAL_COUNT && n < max; i++)
+  {
+    uint16_t id = pgm_read_word(&CAN_SIGNALS[i].id);
+    if (n == 0 || ids[n - 1] != id)
+      ids[n++] = id;
+  }
+  return n;
+}
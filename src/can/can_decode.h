@@ -0,0 +1,12 @@
+#pragma once
+#include "types.h"
+#include "canbus.h"
+
+// Decode every table signal carried by frame into vehicle, and feed each
+// to the session statistics and the stale watchdog (stale_set_clock()
+// first). Returns the set of fields whose value changed.
+SignalMask can_decode_frame(const CanFrame &frame, VehicleState &vehicle);
+
+// Distinct CAN ids the table consumes, ascending. Returns how many were
+// written (at most max).
+uint8_t can_decode_ids(uint16_t *ids, uint8_t max);
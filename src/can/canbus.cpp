@@ -0,0 +1,303 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <mcp_can.h>
+#include "canbus.h"
+#include "can_decode.h"
+#include "config.h"
+#include "pins.h"
+#include "spsc_ring.h"
+
+static MCP_CAN CAN0(CAN_CS);
+
+// Filled by can_drain_hw() (ISR or polled), emptied by read_can()
+static SpscRing<CanFrame, CAN_RX_RING_SIZE> rxRing;
+static bool canReady = false;
+static uint16_t hwOverruns = 0;
+
+// Move every frame the MCP2515 holds into the ring. Runs with the CAN
+// interrupt masked, either as the ISR itself or from can_service().
+static void can_drain_hw()
+{
+  uint16_t now = millis(); // one stamp per drain, all frames read together
+  uint16_t nowUs = micros();
+  while (CAN0.checkReceive() == CAN_MSGAVAIL)
+  {
+    unsigned long id = 0;
+    CanFrame *slot = rxRing.reserve();
+    if (slot)
+    {
+      CAN0.readMsgBuf(&id, &slot->len, slot->data);
+      slot->id = id;
+      slot->tMs = now;
+      slot->tUs = nowUs;
+      rxRing.commit();
+    }
+    else
+    {
+      // Ring full: still read the frame so the MCP2515 releases INT
+      CanFrame scratch;
+      CAN0.readMsgBuf(&id, &scratch.len, scratch.data);
+    }
+  }
+}
+
+#if CAN_RX_USE_ISR
+static void can_isr()
+{
+  can_drain_hw();
+}
+#endif
+
+// -------- Acceptance filters --------
+// The MCP2515 has two masks: RXB0 with filters 0-1 and RXB1 with filters
+// 2-5. We program them from the decoder's id set so unused traffic is
+// rejected in silicon. With more ids than filters, each mask is widened just
+// enough to cover its group, which lets a few extra ids through.
+
+#define CAN_STD_MASK 0x7FF
+
+static uint8_t can_count_distinct(const uint16_t *ids, uint8_t n, uint16_t mask)
+{
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    uint8_t j = 0;
+    while (j < i && (ids[j] & mask) != (ids[i] & mask))
+      j++;
+    if (j == i)
+      count++;
+  }
+  return count;
+}
+
+// Most selective mask under which ids collapse to at most `slots` filter
+// values. Greedy: repeatedly stop comparing the bit that merges the most ids.
+static uint16_t can_fit_mask(const uint16_t *ids, uint8_t n, uint8_t slots)
+{
+  uint16_t mask = CAN_STD_MASK;
+  uint8_t distinct = can_count_distinct(ids, n, mask);
+  while (distinct > slots)
+  {
+    uint16_t bestBit = 0;
+    uint8_t bestCount = 0xFF;
+    for (uint16_t bit = 1; bit & CAN_STD_MASK; bit <<= 1)
+    {
+      if (!(mask & bit))
+        continue;
+      uint8_t c = can_count_distinct(ids, n, mask & ~bit);
+      if (c < bestCount)
+      {
+        bestCount = c;
+        bestBit = bit;
+      }
+    }
+    mask &= ~bestBit;
+    distinct = bestCount;
+  }
+  return mask;
+}
+
+// Upper bound on how many ids a mask plus its filters accept
+static uint16_t can_accept_count(const uint16_t *ids, uint8_t n, uint16_t mask)
+{
+  if (n == 0)
+    return 0;
+  uint8_t dontCare = 0;
+  for (uint16_t bit = 1; bit & CAN_STD_MASK; bit <<= 1)
+    if (!(mask & bit))
+      dontCare++;
+  return (uint16_t)can_count_distinct(ids, n, mask) << dontCare;
+}
+
+// Program one mask and its filters; unused filters repeat the first value.
+static void can_load_group(uint8_t maskNum, uint8_t firstFilt, uint8_t slots,
+                           const uint16_t *ids, uint8_t n, uint16_t fallbackId)
+{
+  uint16_t mask = n ? can_fit_mask(ids, n, slots) : CAN_STD_MASK;
+  CAN0.init_Mask(maskNum, 0, (uint32_t)mask << 16);
+
+  uint16_t filt[4];
+  uint8_t used = 0;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    uint16_t f = ids[i] & mask;
+    uint8_t j = 0;
+    while (j < used && filt[j] != f)
+      j++;
+    if (j == used)
+      filt[used++] = f;
+  }
+  for (uint8_t k = 0; k < slots; k++)
+  {
+    uint16_t f = k < used ? filt[k] : (used ? filt[0] : fallbackId);
+    CAN0.init_Filt(firstFilt + k, 0, (uint32_t)f << 16);
+  }
+}
+
+// Returns how many ids the filters accept (0: left at receive-all)
+static uint16_t can_apply_filters(uint8_t &n)
+{
+  uint16_t ids[CAN_MAX_FILTER_IDS];
+  n = can_decode_ids(ids, CAN_MAX_FILTER_IDS);
+  if (n == 0)
+    return 0; // nothing to decode: leave the receive-all masks from begin()
+
+  // ids are sorted, so try every split into a low group on RXB0 (2 filters)
+  // and a high group on RXB1 (4 filters); keep the one accepting fewest ids.
+  uint8_t bestSplit = 0;
+  uint16_t bestAccept = 0xFFFF;
+  for (uint8_t split = 0; split <= n; split++)
+  {
+    uint16_t m0 = can_fit_mask(ids, split, 2);
+    uint16_t m1 = can_fit_mask(ids + split, n - split, 4);
+    uint16_t accept = can_accept_count(ids, split, m0) + can_accept_count(ids + split, n - split, m1);
+    if (accept < bestAccept)
+    {
+      bestAccept = accept;
+      bestSplit = split;
+    }
+  }
+
+  can_load_group(0, 0, 2, ids, bestSplit, ids[0]);
+  can_load_group(1, 2, 4, ids + bestSplit, n - bestSplit, ids[0]);
+  return bestAccept;
+}
+
+// Everything on the bus: both masks zero, with a standard and an extended
+// filter on each RX buffer so frames of either kind match
+static void can_open_filters()
+{
+  for (uint8_t m = 0; m < 2; m++)
+    CAN0.init_Mask(m, 0, 0);
+  for (uint8_t f = 0; f < 6; f++)
+    CAN0.init_Filt(f, f & 1, 0);
+}
+
+void can_set_filters_open(bool open)
+{
+  if (!canReady)
+    return;
+  uint8_t n;
+  if (open)
+    can_open_filters();
+  else
+    can_apply_filters(n);
+}
+
+// -------- RX overruns --------
+// A frame that arrives while both RX buffers are full is lost inside the
+// MCP2515, e.g. while the CAN interrupt waits out an OLED transfer, and
+// sets EFLG RX0OVR/RX1OVR until cleared. mcp_can reads EFLG but has no call
+// to clear it, so the bit modify goes to the controller directly.
+
+#define MCP_BIT_MODIFY 0x05
+#define MCP_EFLG 0x2D
+#define MCP_EFLG_RX0OVR 0x40
+#define MCP_EFLG_RX1OVR 0x80
+#define MCP_SPI_HZ 10000000 // as mcp_can
+
+static void can_clear_overruns()
+{
+  SPI.beginTransaction(SPISettings(MCP_SPI_HZ, MSBFIRST, SPI_MODE0));
+  digitalWrite(CAN_CS, LOW);
+  SPI.transfer(MCP_BIT_MODIFY);
+  SPI.transfer(MCP_EFLG);
+  SPI.transfer(MCP_EFLG_RX0OVR | MCP_EFLG_RX1OVR); // mask
+  SPI.transfer(0);
+  digitalWrite(CAN_CS, HIGH);
+  SPI.endTransaction();
+}
+
+// One count per RXnOVR bit found set. Overruns between two checks merge
+// into one, so this is a lower bound on the episodes, not on the frames.
+void can_check_overruns()
+{
+  if (!canReady)
+    return;
+  uint8_t eflg = CAN0.getError();
+  if (!(eflg & (MCP_EFLG_RX0OVR | MCP_EFLG_RX1OVR)))
+    return;
+  uint8_t n = ((eflg & MCP_EFLG_RX0OVR) ? 1 : 0) + ((eflg & MCP_EFLG_RX1OVR) ? 1 : 0);
+  hwOverruns = hwOverruns > 0xFFFF - n ? 0xFFFF : hwOverruns + n;
+  can_clear_overruns();
+}
+
+uint8_t can_error_flags()
+{
+  return canReady ? CAN0.getError() : 0;
+}
+
+bool can_init()
+{
+  // Common: MCP_8MHZ or MCP_16MHZ. EMU Black often 500kbps depending on config.
+  if (CAN0.begin(MCP_STDEXT, CAN_BITRATE, CAN_CLOCK) != CAN_OK)
+    return false;
+  uint8_t n;
+  uint16_t accepted = can_apply_filters(n);
+  if (n)
+  {
+    Serial.print("CAN filters: ");
+    Serial.print(n);
+    Serial.print(" ids, ");
+    Serial.print(accepted);
+    Serial.println(" accepted");
+  }
+  CAN0.setMode(MCP_NORMAL);
+  canReady = true;
+
+#if CAN_RX_USE_ISR
+  pinMode(CAN_INT, INPUT);
+  // Let SPI.beginTransaction() mask this interrupt, so the ISR can never
+  // cut into an OLED transfer on the shared bus.
+  SPI.usingInterrupt(digitalPinToInterrupt(CAN_INT));
+  attachInterrupt(digitalPinToInterrupt(CAN_INT), can_isr, FALLING);
+#endif
+  return true;
+}
+
+// Call every loop. In polled mode this is the drain stage; with the ISR it
+// only recovers a missed edge (INT still low with nothing in flight). Then
+// one EFLG read for overruns.
+void can_service()
+{
+  if (!canReady)
+    return;
+#if CAN_RX_USE_ISR
+  if (digitalRead(CAN_INT) == LOW)
+  {
+    noInterrupts();
+    can_drain_hw();
+    interrupts();
+  }
+#else
+  // Safety: ensure OLED not selected while talking to CAN (shared SPI bus)
+  digitalWrite(OLED_CS, HIGH);
+  can_drain_hw();
+#endif
+  can_check_overruns();
+}
+
+bool can_rx_pop(CanFrame &frame)
+{
+  return rxRing.pop(frame);
+}
+
+CanRxStats can_rx_stats()
+{
+  CanRxStats s;
+  noInterrupts();
+  s.dropped = rxRing.dropCount();
+  s.hwOverruns = hwOverruns;
+  s.highWater = rxRing.highWaterMark();
+  s.pending = rxRing.size();
+  interrupts();
+  return s;
+}
+
+void can_rx_reset_stats()
+{
+  noInterrupts();
+  rxRing.resetStats();
+  interrupts();
+  hwOverruns = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+
+// Raw frame as read from the MCP2515
+struct CanFrame
+{
+  uint32_t id;
+  uint8_t len;
+  uint8_t data[8];
+  uint16_t tMs; // millis() when read from the MCP2515, low 16 bits
+  uint16_t tUs; // micros() then, low 16 bits: for latencies under 65 ms
+};
+
+struct CanRxStats
+{
+  uint16_t dropped;    // frames read from the MCP2515 but lost to a full ring
+  uint16_t hwOverruns; // EFLG RXnOVR seen set: at least one frame lost in the MCP2515 each
+  uint8_t highWater; // max ring occupancy seen since last reset
+  uint8_t pending;   // frames waiting for read_can()
+};
+
+bool can_init();
+// Drain fallback, and counts and clears MCP2515 RX overruns
+void can_service();
+// Just the overrun check, for a status read between can_service() calls
+void can_check_overruns();
+bool can_rx_pop(CanFrame &frame);
+CanRxStats can_rx_stats();
+void can_rx_reset_stats();
+// Accept every frame (bridge mode), or back to the decoder's ids
+void can_set_filters_open(bool open);
+// MCP2515 EFLG: error warning/passive, bus off and RXnOVR bits
+uint8_t can_error_flags();
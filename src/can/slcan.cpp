@@ -0,0 +1,322 @@
+#include <Arduino.h>
+#include "slcan.h"
+#include "config.h"
+#include "cobs.h"
+
+#define SLCAN_OK '\r'
+#define SLCAN_ERROR '\a'
+
+#define CAN_ID_EXT 0x80000000UL // set by mcp_can on extended frames
+#define CAN_ID_RTR 0x40000000UL // and on remote frames
+
+// flags, 4 id bytes, time, data
+#define BINARY_RAW_MAX (1 + 4 + 2 + 8)
+#define BINARY_MAX (BINARY_RAW_MAX + 2)
+static_assert(SLCAN_ASCII_MAX >= BINARY_MAX, "slcan_encode() buffer");
+#define BINARY_FLAG_DROPS 0x80
+
+static bool active = false;
+static bool channelOpen = false;
+static bool binary = false;
+static bool timestamps = false;
+static uint8_t pendingFlags = 0; // F bits latched until read
+static uint16_t dropsSeen = 0;   // CanRxStats::dropped when last reported
+static uint16_t overrunsSeen = 0; // and CanRxStats::hwOverruns
+static SlcanStats stats;
+
+static char line[SLCAN_LINE_MAX];
+static uint8_t lineLen = 0;
+static bool lineOverflow = false;
+
+// Timestamps are ms within the minute. Frames carry the low 16 bits of
+// millis(); they're placed against a reference refreshed by slcan_service(),
+// which keeps the division out of the per-frame path.
+static uint16_t tsRefMs = 0;
+static uint16_t tsRefMod = 0; // tsRefMs in ms % 60000
+
+static void ts_rebase(uint32_t nowMs)
+{
+  tsRefMs = nowMs;
+  tsRefMod = nowMs % 60000UL;
+}
+
+static uint16_t ts_of(uint16_t tMs)
+{
+  int32_t t = (int32_t)tsRefMod + (int16_t)(tMs - tsRefMs);
+  if (t < 0)
+    t += 60000;
+  else if (t >= 60000)
+    t -= 60000;
+  return t;
+}
+
+// -------- Output --------
+
+static char hex_digit(uint8_t v)
+{
+  v &= 0x0F;
+  return v < 10 ? '0' + v : 'A' - 10 + v;
+}
+
+static uint8_t put_hex(char *p, uint32_t v, uint8_t digits)
+{
+  for (uint8_t i = digits; i-- > 0;)
+  {
+    p[i] = hex_digit(v);
+    v >>= 4;
+  }
+  return digits;
+}
+
+static uint8_t encode_ascii(char *buf, const CanFrame &frame, uint8_t len, bool ext, bool rtr)
+{
+  uint8_t n = 0;
+  buf[n++] = rtr ? (ext ? 'R' : 'r') : (ext ? 'T' : 't');
+  n += ext ? put_hex(buf + n, frame.id & 0x1FFFFFFFUL, 8) : put_hex(buf + n, frame.id & 0x7FF, 3);
+  buf[n++] = '0' + len;
+  if (!rtr)
+    for (uint8_t i = 0; i < len; i++)
+      n += put_hex(buf + n, frame.data[i], 2);
+  if (timestamps)
+    n += put_hex(buf + n, ts_of(frame.tMs), 4);
+  buf[n++] = '\r';
+  return n;
+}
+
+static uint8_t encode_binary(uint8_t *wire, const CanFrame &frame, uint8_t len, bool ext, bool rtr)
+{
+  uint8_t raw[BINARY_RAW_MAX];
+  uint8_t n = 0;
+  raw[n++] = len | (ext ? 0x10 : 0) | (rtr ? 0x20 : 0);
+  uint32_t id = frame.id & 0x1FFFFFFFUL;
+  for (uint8_t i = 0; i < (ext ? 4 : 2); i++)
+  {
+    raw[n++] = id;
+    id >>= 8;
+  }
+  raw[n++] = frame.tMs;
+  raw[n++] = frame.tMs >> 8;
+  if (!rtr)
+  {
+    memcpy(raw + n, frame.data, len);
+    n += len;
+  }
+  return cobs_encode(wire, raw, n);
+}
+
+bool slcan_ready()
+{
+  return !channelOpen || Serial.availableForWrite() >= (binary ? BINARY_MAX : SLCAN_ASCII_MAX);
+}
+
+uint8_t slcan_encode(const CanFrame &frame, uint8_t *out)
+{
+  uint8_t len = frame.len > 8 ? 8 : frame.len;
+  bool ext = frame.id & CAN_ID_EXT;
+  bool rtr = frame.id & CAN_ID_RTR;
+  if (binary)
+    return encode_binary(out, frame, len, ext, rtr);
+  return encode_ascii((char *)out, frame, len, ext, rtr);
+}
+
+void slcan_frame(const CanFrame &frame)
+{
+  if (!channelOpen)
+    return;
+  uint8_t buf[SLCAN_ASCII_MAX];
+  Serial.write(buf, slcan_encode(frame, buf));
+  stats.frames++;
+}
+
+void slcan_service(uint32_t nowMs)
+{
+  if (!channelOpen)
+    return;
+  ts_rebase(nowMs);
+
+  // Report only once the report itself fits; the count keeps meanwhile
+  if (Serial.availableForWrite() < BINARY_MAX)
+    return;
+  // Deltas of the shared counts, which the debug page keeps showing; a
+  // stats reset in between starts them over from zero
+  CanRxStats can = can_rx_stats();
+  uint16_t drops = can.dropped >= dropsSeen ? can.dropped - dropsSeen : can.dropped;
+  uint16_t overruns = can.hwOverruns >= overrunsSeen ? can.hwOverruns - overrunsSeen : can.hwOverruns;
+  if (!drops && !overruns)
+    return;
+  dropsSeen = can.dropped;
+  overrunsSeen = can.hwOverruns;
+  stats.dropped += drops;
+  stats.overruns += overruns;
+  if (drops)
+    pendingFlags |= 0x01;
+  if (overruns)
+    pendingFlags |= 0x08;
+  if (binary)
+  {
+    uint8_t raw[5] = {BINARY_FLAG_DROPS, (uint8_t)drops, (uint8_t)(drops >> 8),
+                      (uint8_t)overruns, (uint8_t)(overruns >> 8)};
+    uint8_t wire[7];
+    Serial.write(wire, cobs_encode(wire, raw, sizeof(raw)));
+  }
+  else
+  {
+    Serial.print("e1o\r"); // Rx overrun error, as the Linux slcan driver reads it
+  }
+}
+
+// -------- Commands --------
+
+static void channel_open()
+{
+  CanRxStats can = can_rx_stats();
+  dropsSeen = can.dropped;
+  overrunsSeen = can.hwOverruns;
+  can_set_filters_open(true);
+  pendingFlags = 0;
+  memset(&stats, 0, sizeof(stats));
+  ts_rebase(millis());
+  channelOpen = true;
+}
+
+static void channel_close()
+{
+  channelOpen = false;
+  can_set_filters_open(false);
+}
+
+// F: the controller's error state now, plus what was latched since last
+// read. RXnOVR is counted and cleared in the MCP2515 first, so bit 3 covers
+// overruns up to this read; losses slcan_service() has yet to report show
+// here too, and are reported by it as usual.
+static uint8_t status_flags()
+{
+  can_check_overruns();
+  CanRxStats can = can_rx_stats();
+  uint8_t eflg = can_error_flags();
+  uint8_t flags = pendingFlags;
+  if (can.dropped != dropsSeen)
+    flags |= 0x01;
+  if (can.hwOverruns != overrunsSeen)
+    flags |= 0x08;
+  if (eflg & 0x01) // EWARN
+    flags |= 0x04;
+  if (eflg & 0x18) // TXEP, RXEP
+    flags |= 0x20;
+  if (eflg & 0x20) // TXBO
+    flags |= 0x80;
+  pendingFlags = 0;
+  return flags;
+}
+
+static void leave()
+{
+  if (channelOpen)
+    channel_close();
+  active = false;
+  Serial.println();
+  Serial.print("slcan: ");
+  Serial.print(stats.frames);
+  Serial.print(" frames, ");
+  Serial.print(stats.dropped);
+  Serial.print(" dropped, ");
+  Serial.print(stats.overruns);
+  Serial.println(" overruns");
+}
+
+static void command(const char *cmd, uint8_t len)
+{
+  bool ok = false;
+  switch (len ? cmd[0] : '\r')
+  {
+  case '\r': // empty line, slcand sends a few to flush
+    ok = true;
+    break;
+  case 'S':
+    ok = !channelOpen && len == 2 && cmd[1] == SLCAN_BITRATE_CODE;
+    break;
+  case 'O':
+  case 'L':
+    ok = !channelOpen;
+    if (ok)
+      channel_open();
+    break;
+  case 'C':
+    if (channelOpen)
+      channel_close();
+    ok = true;
+    break;
+  case 'F':
+  {
+    char buf[4] = {'F'};
+    put_hex(buf + 1, status_flags(), 2);
+    buf[3] = '\r';
+    Serial.write((const uint8_t *)buf, sizeof(buf));
+    return;
+  }
+  case 'V':
+    Serial.print("V1010\r");
+    return;
+  case 'N':
+    Serial.print("NAMG1\r");
+    return;
+  case 'Z':
+  case 'B':
+    ok = len == 2 && (cmd[1] == '0' || cmd[1] == '1');
+    if (ok && cmd[0] == 'Z')
+      timestamps = cmd[1] == '1';
+    else if (ok)
+      binary = cmd[1] == '1';
+    break;
+  case 'M':
+  case 'm':
+    ok = true; // acceptance code/mask: the filters stay open
+    break;
+  case 'b':
+    leave();
+    return;
+  }
+  Serial.write(ok ? SLCAN_OK : SLCAN_ERROR);
+}
+
+void slcan_start()
+{
+  active = true;
+  lineLen = 0;
+  lineOverflow = false;
+}
+
+bool slcan_active()
+{
+  return active;
+}
+
+bool slcan_open()
+{
+  return channelOpen;
+}
+
+void slcan_input(char c)
+{
+  if (c == '\n')
+    return;
+  if (c != '\r')
+  {
+    if (lineLen < SLCAN_LINE_MAX)
+      line[lineLen++] = c;
+    else
+      lineOverflow = true;
+    return;
+  }
+  if (lineOverflow)
+    Serial.write(SLCAN_ERROR);
+  else
+    command(line, lineLen);
+  lineLen = 0;
+  lineOverflow = false;
+}
+
+const SlcanStats &slcan_stats()
+{
+  return stats;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+#include "canbus.h"
+
+// -------- slcan bridge --------
+// Turns the display into a receive-only USB-CAN adapter: every frame taken
+// off the RX ring is also sent to Serial in the slcan (Lawicel) ASCII
+// protocol, so SocketCAN's slcand can attach to it:
+//
+//   slcand -o -c -s6 -S 1000000 /dev/ttyUSB0 can0
+//
+// The session starts with 'b' on the debug console, or with the C, S or O
+// slcand sends first. From then on Serial takes CR-terminated commands:
+//
+//   S6      bit rate; only SLCAN_BITRATE_CODE (the bus we're on) is accepted
+//   O / L   open: filters widened to every id, frames start flowing
+//   C       close: back to the decoder's filters
+//   F       status flags, cleared by reading: bit 0 frames dropped, bit 2
+//           error warning, bit 3 MCP2515 RX overrun, bit 5 error passive,
+//           bit 7 bus off
+//   Z0/Z1   timestamps off/on (ms within the minute, from the drain stamp)
+//   V, N    version, serial number
+//   B0/B1   (non-standard) ASCII or binary frames
+//   b       (non-standard) leave for the debug console
+//
+// t/T/r/R are refused with a BELL: the bridge never transmits.
+//
+// Frames go out as t<iii><l><data>[<tttt>]\r, T<iiiiiiii>... for extended
+// ids and r/R for remote frames. The binary variant sends each frame as a
+// COBS packet (delimited by 0x00, see tools/can_bridge_decode.py):
+//
+//   flags   (u8)   bits 0-3 length, bit 4 extended, bit 5 remote
+//   id      2 bytes standard / 4 bytes extended, little endian
+//   time    (u16)  CanFrame::tMs, little endian
+//   data    length bytes
+//
+// A frame is only taken off the RX ring when the UART buffer has room for
+// it, so a UART that can't keep up backs frames up into the ring and the
+// losses happen there, where they are counted. Frames can also be lost in
+// the MCP2515 itself when both RX buffers fill before the drain runs; those
+// overruns are counted by can_service(). Each batch of losses is reported
+// as an "e1o" Rx overrun line, besides F bit 0 or 3. In binary it is a
+// packet with flags 0x80, then u16 ring drops and u16 overruns (each at
+// least one frame), little endian.
+//
+// Throughput at SERIAL_BAUD = 1 Mbaud, 8-byte frames, from host replays:
+// ASCII keeps up to ~90% of a 500 kbps bus (drops from ~99%), ASCII with
+// Z1 to ~85% (drops from 88%); binary (B1) takes a saturated bus with
+// room to spare. So ASCII for slcand is for buses below ~90% load, and a
+// full bus needs B1 and tools/can_bridge_decode.py. The AVR's CPU time for
+// the UART interrupt at these rates has not been measured.
+
+void slcan_start();
+bool slcan_active(); // in the bridge's command mode
+bool slcan_open();   // forwarding frames
+// One byte from Serial while active (or the one that started it)
+void slcan_input(char c);
+// Room in the UART buffer for the largest frame; always true when closed
+bool slcan_ready();
+// Forward a frame taken off the RX ring; nothing when closed
+void slcan_frame(const CanFrame &frame);
+
+// Longest ASCII frame: T, 8 id digits, length, 16 data digits, timestamp, CR
+#define SLCAN_ASCII_MAX (1 + 8 + 1 + 16 + 4 + 1)
+// Wire bytes for a frame in the current output format (fits SLCAN_ASCII_MAX)
+uint8_t slcan_encode(const CanFrame &frame, uint8_t *out);
+// Call periodically: reports ring drops and keeps the timestamp base fresh
+void slcan_service(uint32_t nowMs);
+
+struct SlcanStats
+{
+  uint32_t frames;  // forwarded
+  uint32_t dropped;  // lost in the RX ring while open
+  uint32_t overruns; // MCP2515 RX overruns while open
+};
+const SlcanStats &slcan_stats();
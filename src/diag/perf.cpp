@@ -0,0 +1,177 @@
+#include "perf.h"
+#include "can/canbus.h"
+#include "input/input.h"
+
+static PerfStats stats[PERF_STAGE_COUNT];
+
+static const char *const STAGE_NAMES[PERF_STAGE_COUNT] = {
+    "loop", "can", "input", "build", "flush", "shift"};
+
+// Per-second rates
+static uint32_t windowStartMs = 0;
+static uint16_t framesInWindow = 0, canInWindow = 0;
+static uint16_t fps = 0, canRate = 0;
+
+static uint8_t bucket_of(uint32_t us)
+{
+  uint8_t b = 0;
+  while (us > 1 && b < PERF_BUCKETS - 1)
+  {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+void perf_record(PerfStage stage, uint32_t us)
+{
+  PerfStats &s = stats[stage];
+  uint16_t v = us > 0xFFFF ? 0xFFFF : us;
+
+  if (s.count == 0 || v < s.minUs)
+    s.minUs = v;
+  if (v > s.maxUs)
+    s.maxUs = v;
+
+  // Halve the totals instead of overflowing; averages and shape survive
+  if (s.sumUs > 0xF0000000UL)
+  {
+    s.sumUs >>= 1;
+    s.count >>= 1;
+  }
+  s.sumUs += v;
+  s.count++;
+
+  uint16_t &h = s.hist[bucket_of(v)];
+  if (h == 0xFFFF)
+  {
+    for (uint8_t i = 0; i < PERF_BUCKETS; i++)
+      s.hist[i] >>= 1;
+  }
+  h++;
+}
+
+const PerfStats &perf_stats(PerfStage stage)
+{
+  return stats[stage];
+}
+
+const char *perf_stage_name(PerfStage stage)
+{
+  return STAGE_NAMES[stage];
+}
+
+uint16_t perf_avg_us(PerfStage stage)
+{
+  const PerfStats &s = stats[stage];
+  return s.count ? s.sumUs / s.count : 0;
+}
+
+uint16_t perf_p99_us(PerfStage stage)
+{
+  const PerfStats &s = stats[stage];
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < PERF_BUCKETS; i++)
+    total += s.hist[i];
+  if (total == 0)
+    return 0;
+
+  uint32_t below = 0;
+  uint32_t target = total - total / 100; // 99% of samples
+  for (uint8_t i = 0; i < PERF_BUCKETS; i++)
+  {
+    below += s.hist[i];
+    if (below >= target)
+    {
+      uint32_t upper = (2UL << i) - 1;
+      return upper < s.maxUs ? upper : s.maxUs;
+    }
+  }
+  return s.maxUs;
+}
+
+void perf_note_frame()
+{
+  framesInWindow++;
+}
+
+void perf_note_can_frames(uint8_t n)
+{
+  canInWindow += n;
+}
+
+void perf_tick(uint32_t nowMs)
+{
+  uint32_t elapsed = nowMs - windowStartMs;
+  if (elapsed < 1000)
+    return;
+  fps = (uint32_t)framesInWindow * 1000 / elapsed;
+  canRate = (uint32_t)canInWindow * 1000 / elapsed;
+  framesInWindow = canInWindow = 0;
+  windowStartMs = nowMs;
+}
+
+uint16_t perf_fps()
+{
+  return fps;
+}
+
+uint16_t perf_can_rate()
+{
+  return canRate;
+}
+
+int perf_free_sram()
+{
+#ifdef __AVR__
+  // Gap between the top of the heap and the stack
+  extern char __heap_start;
+  extern char *__brkval;
+  char top;
+  return &top - (__brkval ? __brkval : &__heap_start);
+#else
+  return 0;
+#endif
+}
+
+void perf_reset()
+{
+  memset(stats, 0, sizeof(stats));
+  can_rx_reset_stats();
+}
+
+void perf_dump(Print &out)
+{
+  out.println("stage  count  min  avg  p99  max (us)");
+  for (uint8_t i = 0; i < PERF_STAGE_COUNT; i++)
+  {
+    const PerfStats &s = stats[i];
+    out.print(STAGE_NAMES[i]);
+    out.print(' ');
+    out.print(s.count);
+    out.print(' ');
+    out.print(s.minUs);
+    out.print(' ');
+    out.print(perf_avg_us((PerfStage)i));
+    out.print(' ');
+    out.print(perf_p99_us((PerfStage)i));
+    out.print(' ');
+    out.println(s.maxUs);
+  }
+
+  CanRxStats can = can_rx_stats();
+  out.print("fps ");
+  out.print(fps);
+  out.print(" can/s ");
+  out.print(canRate);
+  out.print(" drops ");
+  out.print(can.dropped);
+  out.print(" overruns ");
+  out.print(can.hwOverruns);
+  out.print(" ring hw ");
+  out.print(can.highWater);
+  out.print(" input drops ");
+  out.print(input_dropped());
+  out.print(" free ");
+  out.println(perf_free_sram());
+}
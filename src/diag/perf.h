@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+
+// -------- Timing instrumentation --------
+// Per-stage min/avg/max plus a log2 histogram (bucket i = [2^i, 2^(i+1)) us)
+// for percentiles, all in fixed RAM. Times come from micros(), which has
+// 4 us resolution at 16 MHz.
+
+enum PerfStage : uint8_t
+{
+  PERF_LOOP,     // one scheduler pass
+  PERF_CAN,      // read_can(): ring drain + decode
+  PERF_INPUT,    // buttons and paddles
+  PERF_UI_BUILD, // rebuild frame in RAM
+  PERF_UI_FLUSH, // one SPI flush slice
+  PERF_SHIFT,    // RPM frame read from the MCP2515 to shift light on/off command sent
+  PERF_STAGE_COUNT
+};
+
+#define PERF_BUCKETS 16
+
+struct PerfStats
+{
+  uint32_t count;
+  uint32_t sumUs;
+  uint16_t minUs;
+  uint16_t maxUs;
+  uint16_t hist[PERF_BUCKETS];
+};
+
+void perf_record(PerfStage stage, uint32_t us);
+const PerfStats &perf_stats(PerfStage stage);
+const char *perf_stage_name(PerfStage stage);
+uint16_t perf_avg_us(PerfStage stage);
+uint16_t perf_p99_us(PerfStage stage); // upper bound of the p99 bucket
+
+void perf_note_frame();                 // a display frame finished sending
+void perf_note_can_frames(uint8_t n);   // frames decoded
+void perf_tick(uint32_t nowMs);         // roll the per-second rates
+uint16_t perf_fps();
+uint16_t perf_can_rate();               // frames/s
+int perf_free_sram();
+
+void perf_reset();
+void perf_dump(Print &out);
+
+// Times the rest of the enclosing block
+class PerfScope
+{
+public:
+  explicit PerfScope(PerfStage stage) : stage(stage), startUs(micros()) {}
+  ~PerfScope() { perf_record(stage, micros() - startUs); }
+
+private:
+  PerfStage stage;
+  uint32_t startUs;
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(stage) PerfScope PERF_CONCAT(perfScope, __LINE__)(stage)
@@ -0,0 +1,57 @@
+#include "history.h"
+#include "vehicle/vehicle.h"
+
+static_assert((HISTORY_LEN & (HISTORY_LEN - 1)) == 0 && HISTORY_LEN <= 128,
+              "HISTORY_LEN must be a power of two, at most 128");
+
+static const HistChannelInfo CHANNELS[HIST_COUNT] = {
+    //  name      sig         min  max   ref
+    {"RPM",    SIG_RPM,    0,   8000, 0},
+    {"MAP",    SIG_MAP,    0,   250,  100},
+    {"Lambda", SIG_LAMBDA, 700, 1300, 1000},
+    {"TPS",    SIG_TPS,    0,   100,  0},
+};
+
+static uint8_t ring[HIST_COUNT][HISTORY_LEN];
+static uint16_t nextSeq = 0;
+static uint8_t held = 0;
+
+const HistChannelInfo &history_info(HistChannel ch)
+{
+  return CHANNELS[ch];
+}
+
+uint8_t history_level(HistChannel ch, int32_t value)
+{
+  const HistChannelInfo &c = CHANNELS[ch];
+  if (value <= c.min)
+    return 0;
+  if (value >= c.max)
+    return 255;
+  return (uint32_t)(value - c.min) * 255 / (uint16_t)(c.max - c.min);
+}
+
+void history_sample(const VehicleState &vehicle)
+{
+  uint8_t i = nextSeq & (HISTORY_LEN - 1);
+  for (uint8_t ch = 0; ch < HIST_COUNT; ch++)
+    ring[ch][i] = history_level((HistChannel)ch, vehicle_get(vehicle, CHANNELS[ch].sig));
+  nextSeq++;
+  if (held < HISTORY_LEN)
+    held++;
+}
+
+uint16_t history_seq()
+{
+  return nextSeq;
+}
+
+uint8_t history_count()
+{
+  return held;
+}
+
+uint8_t history_at(HistChannel ch, uint16_t seq)
+{
+  return ring[ch][seq & (HISTORY_LEN - 1)];
+}
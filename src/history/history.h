@@ -0,0 +1,34 @@
+#pragma once
+#include "types.h"
+
+// -------- Signal history --------
+// The last HISTORY_LEN samples of a few signals, taken every
+// HISTORY_SAMPLE_MS from the decoded VehicleState. Each sample is one byte:
+// the value mapped linearly onto 0..255 over the channel's range (clamped).
+enum HistChannel : uint8_t
+{
+  HIST_RPM,
+  HIST_MAP,
+  HIST_LAMBDA,
+  HIST_TPS,
+  HIST_COUNT
+};
+
+struct HistChannelInfo
+{
+  const char *name;
+  SignalId sig;
+  int16_t min, max;  // range of the 0..255 levels
+  int16_t ref;       // reference level drawn on charts, if min < ref < max
+};
+
+const HistChannelInfo &history_info(HistChannel ch);
+uint8_t history_level(HistChannel ch, int32_t value);
+
+void history_sample(const VehicleState &vehicle);
+
+// Samples are numbered from 0 in the order taken; the number wraps at 16
+// bits. Only the last history_count() of them are kept.
+uint16_t history_seq();   // number of the next sample
+uint8_t history_count();  // samples held, up to HISTORY_LEN
+uint8_t history_at(HistChannel ch, uint16_t seq);
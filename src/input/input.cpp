@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include "input.h"
+#include "config.h"
+#include "pins.h"
+#include "spsc_ring.h"
+
+struct InputEdge
+{
+  InputSource src;
+  uint8_t level;
+  uint16_t tMs;
+};
+
+// Per source debounce and gesture state, all times low 16 bits of millis()
+struct InputState
+{
+  uint8_t raw;    // level after the last edge
+  uint8_t stable; // debounced level (HIGH = released, pull-ups)
+  uint16_t edgeMs;
+  uint16_t pressMs; // last debounced press
+  bool tapArmed;    // last press can still become a double tap
+};
+
+static const uint8_t PINS[IN_SOURCE_COUNT] = {PADDLE_L_PIN, PADDLE_R_PIN, BTN_MODE, BTN_PAGE};
+
+static SpscRing<InputEdge, INPUT_EDGE_RING_SIZE> edges; // ISR -> input_poll()
+static SpscRing<InputEvent, INPUT_EVENT_RING_SIZE> events;
+static InputState state[IN_SOURCE_COUNT];
+static bool bothHoldFired = false;
+static uint16_t droppedSeen = 0; // input_dropped() at the last resync
+
+// -------- Edge capture --------
+
+static void capture_edge(InputSource src)
+{
+  InputEdge *e = edges.reserve();
+  if (!e)
+    return;
+  e->src = src;
+  e->level = digitalRead(PINS[src]);
+  e->tMs = millis();
+  edges.commit();
+}
+
+static void paddle_l_isr()
+{
+  capture_edge(IN_PADDLE_L);
+}
+
+static void paddle_r_isr()
+{
+  capture_edge(IN_PADDLE_R);
+}
+
+void input_init()
+{
+  uint16_t now = millis();
+  for (uint8_t i = 0; i < IN_SOURCE_COUNT; i++)
+  {
+    pinMode(PINS[i], INPUT_PULLUP);
+    state[i].raw = state[i].stable = digitalRead(PINS[i]);
+    state[i].edgeMs = now;
+    state[i].tapArmed = false;
+  }
+  attachInterrupt(digitalPinToInterrupt(PADDLE_L_PIN), paddle_l_isr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PADDLE_R_PIN), paddle_r_isr, CHANGE);
+}
+
+// -------- Debounce and gestures --------
+
+static void emit(InputSource src, InputGesture gesture, uint16_t tMs)
+{
+  events.push({src, gesture, tMs});
+}
+
+// Debounced level change, dated by the edge that started it
+static void on_stable(InputSource src, uint16_t tMs)
+{
+  InputState &s = state[src];
+  if (s.stable != LOW)
+    return; // release
+
+  emit(src, IN_PRESS, tMs);
+  if (s.tapArmed && (uint16_t)(tMs - s.pressMs) <= DOUBLE_TAP_MS)
+  {
+    emit(src, IN_DOUBLE_TAP, tMs);
+    s.tapArmed = false;
+  }
+  else
+  {
+    s.tapArmed = true;
+  }
+  s.pressMs = tMs;
+}
+
+// Accept the raw level if it has held for DEBOUNCE_MS by tMs
+static void settle(InputSource src, uint16_t tMs)
+{
+  InputState &s = state[src];
+  if (s.raw != s.stable && (uint16_t)(tMs - s.edgeMs) >= DEBOUNCE_MS)
+  {
+    s.stable = s.raw;
+    on_stable(src, s.edgeMs);
+  }
+}
+
+static void on_edge(InputSource src, uint8_t level, uint16_t tMs)
+{
+  InputState &s = state[src];
+  settle(src, tMs); // the level before this edge may have held long enough
+  if (level == s.raw)
+    return;
+  s.raw = level;
+  s.edgeMs = tMs;
+}
+
+static void check_both_hold(uint16_t now)
+{
+  const InputState &l = state[IN_PADDLE_L];
+  const InputState &r = state[IN_PADDLE_R];
+  if (l.stable != LOW || r.stable != LOW)
+  {
+    bothHoldFired = false;
+    return;
+  }
+  // Held together since the later of the two presses
+  uint16_t since = (uint16_t)(l.pressMs - r.pressMs) < 0x8000 ? l.pressMs : r.pressMs;
+  if (!bothHoldFired && (uint16_t)(now - since) >= BOTH_HOLD_MS)
+  {
+    bothHoldFired = true;
+    emit(IN_PADDLE_L, IN_BOTH_HOLD, since + BOTH_HOLD_MS);
+  }
+}
+
+void input_poll(uint32_t nowMs)
+{
+  uint16_t now = nowMs;
+
+  InputEdge e;
+  while (edges.pop(e))
+    on_edge(e.src, e.level, e.tMs);
+
+  // A full ring lost edges, maybe the last one of a bounce: take the
+  // paddles' level as it is now, or raw could stay wrong until the next edge
+  uint16_t dropped = input_dropped();
+  if (dropped != droppedSeen)
+  {
+    droppedSeen = dropped;
+    for (uint8_t i = IN_PADDLE_L; i <= IN_PADDLE_R; i++)
+      on_edge((InputSource)i, digitalRead(PINS[i]), now);
+  }
+
+  for (uint8_t i = IN_BTN_MODE; i <= IN_BTN_PAGE; i++)
+    on_edge((InputSource)i, digitalRead(PINS[i]), now);
+
+  for (uint8_t i = 0; i < IN_SOURCE_COUNT; i++)
+    settle((InputSource)i, now);
+  check_both_hold(now);
+}
+
+bool input_next(InputEvent &e)
+{
+  return events.pop(e);
+}
+
+uint16_t input_dropped()
+{
+  noInterrupts();
+  uint16_t n = edges.dropCount();
+  interrupts();
+  return n;
+}
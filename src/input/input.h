@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+// -------- Inputs --------
+// The paddles (pins 2 and 3, INT4/INT5) timestamp every edge from an
+// external interrupt into a ring; the buttons (pins 4 and 5 have neither
+// INTn nor PCINT on the Mega) are sampled each input_poll() instead.
+// input_poll() debounces from those timestamps and recognizes gestures, so
+// a press is dated when it happened, not when loop() got around to it.
+// A level counts once it has held for DEBOUNCE_MS.
+
+enum InputSource : uint8_t
+{
+  IN_PADDLE_L,
+  IN_PADDLE_R,
+  IN_BTN_MODE,
+  IN_BTN_PAGE,
+  IN_SOURCE_COUNT
+};
+
+enum InputGesture : uint8_t
+{
+  IN_PRESS,      // every debounced press
+  IN_DOUBLE_TAP, // second press within DOUBLE_TAP_MS (after its IN_PRESS)
+  IN_BOTH_HOLD,  // both paddles held for BOTH_HOLD_MS, once per hold (src = IN_PADDLE_L)
+};
+
+struct InputEvent
+{
+  InputSource src;
+  InputGesture gesture;
+  uint16_t tMs; // millis() when it happened, low 16 bits
+};
+
+void input_init();
+void input_poll(uint32_t nowMs);
+bool input_next(InputEvent &e); // gestures recognized by input_poll(), oldest first
+uint16_t input_dropped();       // paddle edges lost to a full ring
@@ -1,56 +1,269 @@
 #include <SPI.h>
 #include <U8g2lib.h>
-#include <mcp_can.h>
 #include "amg_logo.h" // defines AMG_W, AMG_H, amg_bits[]
 #include "pins.h"
 #include "types.h"
 #include "config.h"
 #include "ui/ui.h"
 #include "prnd/prnd.h"
+#include "input/input.h"
+#include "can/canbus.h"
+#include "can/can_decode.h"
+#include "sched/sched.h"
+#include "diag/perf.h"
+#include "history/history.h"
+#include "stats/stats.h"
+#include "alarm/alarm.h"
+#include "vehicle/stale.h"
+#include "shift/shift.h"
+#include "persist/persist.h"
+#include "vehicle/odometer.h"
+#include "telemetry/telemetry.h"
+#include "can/slcan.h"
 
-// -------- CAN --------
-MCP_CAN CAN0(CAN_CS);
+#ifdef BENCH
+#include <avr/sleep.h>
+#include "bench/bench.h"
+#endif
 
 uint32_t lastUiMs = 0;
 
 VehicleState vehicle;
 
-Button btnMode, btnPage, paddleL, paddleR;
-
 // -------- CAN decoded values (fill these from EMU Black frames) --------
 volatile uint32_t lastCanMs = 0;
 
 // ----------------- CAN reading -----------------
-void read_can()
+// Frames arrive in the RX ring from the MCP2515 ISR; decode them in batches
+// so a long backlog can't starve the rest of loop(). In bridge mode a frame
+// only leaves the ring once the UART has room to forward it. Returns true
+// if the batch filled up and more frames may be waiting.
+bool read_can()
 {
-  // Safety: ensure OLED not selected while talking to CAN (shared SPI bus)
-  digitalWrite(OLED_CS, HIGH);
+  PERF_SCOPE(PERF_CAN);
+  can_service();
 
-  while (CAN0.checkReceive() == CAN_MSGAVAIL)
+  CanFrame frame;
+  uint8_t n = 0;
+  SignalMask changed = 0;
+  uint16_t rpmFrameUs = 0; // drain stamp of the last frame that moved RPM
+  stale_set_clock(millis());
+  while (n < CAN_DECODE_BATCH && slcan_ready() && can_rx_pop(frame))
   {
-    unsigned long canId = 0;
-    uint8_t len = 0;
-    uint8_t buf[8];
-    CAN0.readMsgBuf(&canId, &len, buf);
     lastCanMs = millis();
+    SignalMask c = can_decode_frame(frame, vehicle);
+    if (c & SIG_BIT(SIG_RPM))
+      rpmFrameUs = frame.tUs;
+    changed |= c;
+    slcan_frame(frame);
+    n++;
+  }
+  perf_note_can_frames(n);
+  alarm_update(changed, vehicle, millis());
+
+  // Shift light latency: from the RPM frame leaving the MCP2515 to the
+  // invert command, when that frame crossed the shift point (flash toggles
+  // and stale RPM are timer driven)
+  bool wasActive = shift_active();
+  if (shift_update(vehicle, millis()) && shift_active() != wasActive && (changed & SIG_BIT(SIG_RPM)))
+    perf_record(PERF_SHIFT, (uint16_t)((uint16_t)micros() - rpmFrameUs));
+  return n == CAN_DECODE_BATCH;
+}
+
+// ----------------- Tasks -----------------
+static bool task_can()
+{
+  return read_can();
+}
+
+static bool task_input()
+{
+  PERF_SCOPE(PERF_INPUT);
+  input_poll(millis());
+
+  InputEvent e;
+  while (input_next(e))
+  {
+    if (e.src == IN_PADDLE_L || e.src == IN_PADDLE_R)
+      prnd_input(vehicle, e);
+    else if (e.gesture == IN_PRESS && e.src == IN_BTN_MODE)
+      mode_button(vehicle);
+    else if (e.gesture == IN_PRESS && e.src == IN_BTN_PAGE)
+      next_page();
+  }
+  updateSelectWindow();
+  return false;
+}
+
+// Fixed-rate bookkeeping: chart samples and time past the stats thresholds
+static bool task_history()
+{
+  history_sample(vehicle);
+  stats_tick(millis());
+  return false;
+}
+
+// Odometer, trip and stats to EEPROM, a byte at a time
+static bool task_persist()
+{
+  persist_service(vehicle, millis());
+  return false;
+}
+
+static bool task_ui()
+{
+  stale_check(millis());
+  return draw_ui(vehicle);
+}
+
+static bool task_report();
+
+// Keeps feeding the UART while a frame is going out
+static bool task_telemetry()
+{
+  return telemetry_service(vehicle, millis());
+}
+
+static bool telemetrySummaryDue = false; // 'T' stopped the stream
+static char slcanDeferred = 0;           // bridge command that stopped the stream
+
+static void print_telemetry_summary()
+{
+  Serial.println();
+  Serial.print("telemetry: ");
+  Serial.print(telemetry_stats().frames);
+  Serial.print(" frames, ");
+  Serial.print(telemetry_stats().skipped);
+  Serial.print(" skipped, ");
+  Serial.print(telemetry_stats().bytes);
+  Serial.println(" bytes");
+}
 
-    // TODO: Replace these with *real* EMU Black IDs and scaling.
-    // Example placeholders:
-    if (canId == 0x100 && len >= 2)
-      vehicle.rpm = (int)(buf[0] | (buf[1] << 8));
-    if (canId == 0x101 && len >= 1)
-      vehicle.gear = (int8_t)buf[0]; // maybe signed
-    if (canId == 0x102 && len >= 1)
-      vehicle.tps = buf[0];
-    if (canId == 0x103 && len >= 1)
-      vehicle.clt = (int8_t)buf[0];
-    if (canId == 0x104 && len >= 1)
-      vehicle.iat = (int8_t)buf[0];
-
-    // etc...
+// The stream is stopped but its last frame is still going out
+static bool telemetry_finishing()
+{
+  return !telemetry_active() && telemetry_sending();
+}
+
+static void slcan_enter(char c)
+{
+  slcan_start();
+  if (c != 'b')
+    slcan_input(c);
+}
+
+static void serial_command(char c)
+{
+  // No text in the binary stream: dumps are ignored and resets go
+  // unconfirmed while it runs
+  bool quiet = telemetry_active();
+  switch (c)
+  {
+  case 'p':
+    if (!quiet)
+      perf_dump(Serial);
+    break;
+  case 'r':
+    perf_reset();
+    if (!quiet)
+      Serial.println("perf reset");
+    break;
+  case 's':
+    if (!quiet)
+      stats_dump(Serial);
+    break;
+  case 't':
+    odometer_reset_trip(vehicle);
+    if (!quiet)
+      Serial.println("trip reset");
+    break;
+  case 'T':
+    if (!telemetry_active())
+    {
+      telemetry_start();
+      break;
+    }
+    telemetry_stop();
+    telemetrySummaryDue = true;
+    break;
+  case 'b':
+  case 'C': // slcand opens with these: no 'b' needed after a reset
+  case 'O':
+  case 'S':
+    if (telemetry_active())
+    {
+      telemetry_stop();
+      slcanDeferred = c;
+      break;
+    }
+    slcan_enter(c);
+    break;
   }
 }
 
+// Serial commands for bench diagnostics
+static bool task_serial()
+{
+  perf_tick(millis());
+  slcan_service(millis());
+
+  // After the stream stops, the frame still going out finishes first:
+  // the summary, the bridge and further commands wait for it
+  if (telemetry_finishing())
+    return false;
+  if (telemetrySummaryDue)
+  {
+    telemetrySummaryDue = false;
+    print_telemetry_summary();
+  }
+  if (slcanDeferred)
+  {
+    slcan_enter(slcanDeferred);
+    slcanDeferred = 0;
+  }
+
+  while (Serial.available() > 0 && !telemetry_finishing())
+  {
+    char c = Serial.read();
+    if (slcan_active())
+      slcan_input(c);
+    else
+      serial_command(c);
+  }
+  return false;
+}
+
+// CAN first so decoding always gets in between render slices
+static SchedTask tasks[] = {
+    //         name       fn              prio period              deadline             budget
+    SCHED_TASK("can",     task_can,       0,   CAN_TASK_PERIOD_MS, 2,                   CAN_TASK_BUDGET_US),
+    SCHED_TASK("input",   task_input,     1,   INPUT_PERIOD_MS,    2 * INPUT_PERIOD_MS, INPUT_TASK_BUDGET_US),
+    SCHED_TASK("history", task_history,   1,   HISTORY_SAMPLE_MS,  HISTORY_SAMPLE_MS,   HISTORY_TASK_BUDGET_US),
+    SCHED_TASK("ui",      task_ui,        2,   UI_MIN_FRAME_MS,    UI_PERIOD_MS,        UI_TASK_BUDGET_US),
+    SCHED_TASK("persist", task_persist,   3,   PERSIST_PERIOD_MS,  SERIAL_POLL_MS,      PERSIST_TASK_BUDGET_US),
+    SCHED_TASK("serial",  task_serial,    3,   SERIAL_POLL_MS,     SERIAL_POLL_MS,      0xFFFF),
+    SCHED_TASK("report",  task_report,    3,   SCHED_REPORT_MS,    SCHED_REPORT_MS,     0xFFFF),
+    SCHED_TASK("telem",   task_telemetry, 3,   1,                  TELEMETRY_PERIOD_MS, TELEMETRY_TASK_BUDGET_US),
+};
+
+static const uint8_t TASK_COUNT = sizeof(tasks) / sizeof(tasks[0]);
+
+// Per-task overruns since the last report, so config.h can be tuned
+static bool task_report()
+{
+  if (telemetry_active() || slcan_active())
+    return false; // no text in the binary stream or between slcan replies
+  bool any = false;
+  for (uint8_t i = 0; i < TASK_COUNT; i++)
+    any |= tasks[i].overruns || tasks[i].misses;
+  if (any)
+  {
+    sched_report(Serial, tasks, TASK_COUNT);
+    sched_reset_stats(tasks, TASK_COUNT);
+  }
+  return false;
+}
+
 void setup()
 {
   // CS pins idle high
@@ -59,40 +272,36 @@ void setup()
   digitalWrite(OLED_CS, HIGH);
   digitalWrite(CAN_CS, HIGH);
 
-  btnMode.begin(BTN_MODE);
-  btnPage.begin(BTN_PAGE);
-  paddleL.begin(PADDLE_L_PIN);
-  paddleR.begin(PADDLE_R_PIN);
+  input_init();
 
   SPI.begin();
   ui_init();
-  Serial.begin(115200);
-
-  // // Init CAN: adjust bitrate + oscillator for your MCP2515 module
-  // // Common: MCP_8MHZ or MCP_16MHZ. EMU Black often 500kbps depending on config.
-  // if (CAN0.begin(MCP_ANY, CAN_500KBPS, MCP_8MHZ) != CAN_OK) {
-  //   u8g2.clearBuffer();
-  //   u8g2.setFont(u8g2_font_6x10_tf);
-  //   u8g2.drawStr(0, 12, "CAN init FAIL");
-  //   u8g2.sendBuffer();
-  //   while (true) {}
-  // }
-  // CAN0.setMode(MCP_NORMAL);
+  shift_init();
+  alarm_init();
+  persist_init(vehicle);
+  Serial.begin(SERIAL_BAUD);
+
+  // Init CAN: adjust bitrate + oscillator for your MCP2515 module (config.h).
+  // Keep running without it so the UI still works on the bench.
+  if (!can_init())
+    Serial.println("CAN init FAIL");
+
+#ifdef BENCH
+  // env:bench_avr: report and stop. Sleeping with interrupts off ends a
+  // simavr run.
+  bench_run(Serial);
+  Serial.flush();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  cli();
+  sleep_cpu();
+#endif
 
   draw_splash(); // draw once
 }
 
 void loop()
 {
-
-  read_can(); // keep CAN serviced always
-  updatePaddles(vehicle, paddleL, paddleR);
-
-  // Buttons
-  if (btnMode.pressed())
-    cycleDriveMode(vehicle);
-  if (btnPage.pressed())
-    next_page();
-
-  draw_ui(vehicle);
+  PERF_SCOPE(PERF_LOOP);
+  sched_run(tasks, TASK_COUNT);
 }
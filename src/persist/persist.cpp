@@ -0,0 +1,192 @@
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include "persist.h"
+#include "config.h"
+#include "crc16.h"
+#include "vehicle/odometer.h"
+
+#define BLANK_SEQ 0xFFFF
+#define NO_SLOT 0xFF
+
+static_assert((E2END + 1 - PERSIST_BASE) / sizeof(PersistRecord) >= 2, "PersistRecord must fit the EEPROM at least twice");
+static_assert(offsetof(PersistRecord, seq) == 0, "seq is written last and read first");
+static_assert(sizeof(PersistRecord) <= 255, "writePos is 8-bit");
+static_assert((E2END + 1 - PERSIST_BASE) / sizeof(PersistRecord) < NO_SLOT, "slot index is 8-bit");
+
+static const uint8_t SLOT_COUNT = (E2END + 1 - PERSIST_BASE) / sizeof(PersistRecord);
+
+static uint8_t newestSlot = SLOT_COUNT - 1; // next save goes after it
+static uint16_t newestSeq = BLANK_SEQ;
+static uint16_t savedDataCrc = 0;          // change detection
+static uint32_t lastSaveMs = 0;
+static uint32_t savedOdo = 0;   // km at the last snapshot
+static bool wasMoving = false;
+static bool stopSaveDue = false;
+
+// Save in progress: staged record, destination and write position
+static PersistRecord staged;
+static uint8_t stagedSlot = NO_SLOT;
+static uint8_t writePos = 0;
+
+// Over the record up to its crc. The layout version is folded into the
+// seed so records from an older layout read as invalid.
+static uint16_t record_crc(const PersistRecord &r)
+{
+  return crc16_ccitt(0xFFFF ^ PERSIST_VERSION, (const uint8_t *)&r, offsetof(PersistRecord, crc));
+}
+
+// Payload only, without seq and crc
+static uint16_t data_crc(const PersistRecord &r)
+{
+  return crc16_ccitt(0xFFFF, (const uint8_t *)&r.odo, offsetof(PersistRecord, crc) - offsetof(PersistRecord, odo));
+}
+
+static uint8_t *slot_addr(uint8_t slot)
+{
+  return (uint8_t *)(PERSIST_BASE + (uint16_t)slot * sizeof(PersistRecord));
+}
+
+// Serial number order, so seq can wrap
+static bool seq_newer(uint16_t a, uint16_t b)
+{
+  return (int16_t)(a - b) > 0;
+}
+
+// -------- Startup --------
+
+static void load(const PersistRecord &r, VehicleState &vehicle)
+{
+  vehicle.odo = r.odo;
+  vehicle.trip = r.trip;
+  odometer_restore(r.odoFracM, r.tripFracM);
+  for (uint8_t i = 0; i < STATS_COUNT; i++)
+    stats_load((SignalId)i, r.stats[i]);
+}
+
+static void snapshot(PersistRecord &r, const VehicleState &vehicle)
+{
+  r.odo = vehicle.odo;
+  r.trip = vehicle.trip;
+  r.odoFracM = odometer_odo_frac_m();
+  r.tripFracM = odometer_trip_frac_m();
+  for (uint8_t i = 0; i < STATS_COUNT; i++)
+    r.stats[i] = stats_get((SignalId)i);
+}
+
+bool persist_init(VehicleState &vehicle)
+{
+  stagedSlot = NO_SLOT;
+
+  // Headers only: the newest seq marks where the ring was last written
+  uint8_t newest = 0xFF;
+  uint16_t seq = BLANK_SEQ;
+  for (uint8_t s = 0; s < SLOT_COUNT; s++)
+  {
+    uint16_t v = eeprom_read_word((const uint16_t *)slot_addr(s));
+    if (v != BLANK_SEQ && (newest == 0xFF || seq_newer(v, seq)))
+    {
+      newest = s;
+      seq = v;
+    }
+  }
+
+  // Walk back from it until a record checks out (the newest may be torn)
+  for (uint8_t n = 0; newest != 0xFF && n < SLOT_COUNT; n++)
+  {
+    PersistRecord r;
+    eeprom_read_block(&r, slot_addr(newest), sizeof(r));
+    if (r.seq != BLANK_SEQ && r.crc == record_crc(r))
+    {
+      load(r, vehicle);
+      newestSlot = newest;
+      newestSeq = r.seq;
+      savedDataCrc = data_crc(r);
+      savedOdo = vehicle.odo;
+      return true;
+    }
+    newest = newest ? newest - 1 : SLOT_COUNT - 1;
+  }
+  savedOdo = vehicle.odo;
+  return false;
+}
+
+// -------- Saving --------
+
+static void start_save(const VehicleState &vehicle)
+{
+  snapshot(staged, vehicle);
+  uint16_t crc = data_crc(staged);
+  if (crc == savedDataCrc && newestSeq != BLANK_SEQ)
+    return;
+  savedDataCrc = crc;
+
+  staged.seq = newestSeq + 1;
+  if (staged.seq == BLANK_SEQ)
+    staged.seq = 0;
+  staged.crc = record_crc(staged);
+  stagedSlot = newestSlot + 1 < SLOT_COUNT ? newestSlot + 1 : 0;
+  writePos = 0;
+}
+
+void persist_service(const VehicleState &vehicle, uint32_t nowMs)
+{
+  // Coming to a stop is when the ignition is likely to go off next
+  bool moving = vehicle.speed != 0;
+  if (wasMoving && !moving)
+    stopSaveDue = true;
+  wasMoving = moving;
+
+  if (stagedSlot == NO_SLOT)
+  {
+    // Events wait out the spacing rather than being dropped
+    uint32_t since = nowMs - lastSaveMs;
+    bool eventDue = vehicle.odo != savedOdo || stopSaveDue;
+    if (since < PERSIST_SAVE_MS && !(eventDue && since >= PERSIST_EVENT_MIN_MS))
+      return;
+    lastSaveMs = nowMs;
+    savedOdo = vehicle.odo;
+    stopSaveDue = false;
+    start_save(vehicle);
+    if (stagedSlot == NO_SLOT)
+      return;
+  }
+
+  // A write started last run may still be programming: never wait for it
+  if (!eeprom_is_ready())
+    return;
+
+  // Bytes after seq first, seq last; skip bytes that already match
+  const uint8_t *src = (const uint8_t *)&staged;
+  uint8_t *dst = slot_addr(stagedSlot);
+  while (writePos < sizeof(PersistRecord))
+  {
+    uint8_t i = writePos + sizeof(staged.seq) < sizeof(PersistRecord)
+                    ? writePos + sizeof(staged.seq)
+                    : writePos + sizeof(staged.seq) - sizeof(PersistRecord);
+    writePos++;
+    if (eeprom_read_byte(dst + i) != src[i])
+    {
+      eeprom_write_byte(dst + i, src[i]); // starts it, returns at once
+      return;
+    }
+  }
+
+  newestSlot = stagedSlot;
+  newestSeq = staged.seq;
+  stagedSlot = NO_SLOT;
+}
+
+bool persist_busy()
+{
+  return stagedSlot != NO_SLOT;
+}
+
+uint8_t persist_slot_count()
+{
+  return SLOT_COUNT;
+}
+
+uint16_t persist_seq()
+{
+  return newestSeq;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "types.h"
+#include "stats/stats.h"
+
+// -------- Persistence --------
+// The EEPROM holds a ring of fixed-size records. Every save writes the
+// next slot with a sequence number one higher, so wear spreads over all
+// slots. Within a slot only bytes that differ from what is there get
+// written. The sequence number goes last and the CRC covers it, so a save
+// cut off by power loss leaves an invalid slot and the previous record wins.
+
+struct PersistRecord
+{
+  uint16_t seq;       // 0xFFFF = blank slot
+  uint32_t odo;       // km
+  uint32_t trip;      // km
+  uint16_t odoFracM;  // m into the current km
+  uint16_t tripFracM; // m into the current trip km
+  SignalStats stats[STATS_COUNT];
+  uint16_t crc;       // CRC-16/CCITT of everything before it
+};
+
+// Finds the newest valid record (reads only the slot headers, then checks
+// CRCs from the newest down) and loads it into vehicle and the stats.
+// Returns false on a blank or unreadable EEPROM; vehicle keeps its defaults.
+bool persist_init(VehicleState &vehicle);
+// Call often. Snapshots a record every PERSIST_SAVE_MS, on each new
+// odometer km and when the car comes to a stop (those two no sooner than
+// PERSIST_EVENT_MIN_MS after the last save), if anything changed; then
+// writes it out one byte per call while the EEPROM is ready. Nothing saves
+// at power-down, so this bounds what an ignition-off loses.
+void persist_service(const VehicleState &vehicle, uint32_t nowMs);
+bool persist_busy();           // a save is being written
+uint8_t persist_slot_count();
+uint16_t persist_seq();        // of the newest complete record
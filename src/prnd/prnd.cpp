@@ -2,80 +2,61 @@
 #include <types.h>
 #include <pins.h>
 #include <config.h>
+#include "prnd.h"
 
 bool selectWindowActive = false;
-uint32_t selectWindowStartMs = 0;
+uint16_t selectWindowStartMs = 0; // low 16 bits of millis(), like InputEvent::tMs
 
-// combo / window tracking
-bool bothHoldArmed = false;
-uint32_t bothPressedSinceMs = 0;
-
-void openDriveSelectWindow()
+static void open_select_window(uint16_t tMs)
 {
   selectWindowActive = true;
-  selectWindowStartMs = millis();
+  selectWindowStartMs = tMs;
 }
 
-void updatePaddles(VehicleState& vehicle, Button& paddleL, Button& paddleR)
+void openDriveSelectWindow()
 {
-  // Update debouncers and capture press edges
-  bool leftPressedEdge = paddleL.pressedEdge();
-  bool rightPressedEdge = paddleR.pressedEdge();
-
-  bool leftHeld = paddleL.isPressedNow();
-  bool rightHeld = paddleR.isPressedNow();
-  uint32_t now = millis();
+  open_select_window(millis());
+}
 
-  // --- 1) BOTH-HOLD gesture (1s) triggers P -> N and opens 500ms window ---
-  if (leftHeld && rightHeld)
+void prnd_input(VehicleState& vehicle, const InputEvent& e)
+{
+  // --- 1) BOTH-HOLD gesture (1s) opens the selection window ---
+  // If you later want "both hold to go to N from anywhere", do it here.
+  if (e.gesture == IN_BOTH_HOLD)
   {
-    if (bothPressedSinceMs == 0)
-      bothPressedSinceMs = now;
+    open_select_window(e.tMs);
+    return;
+  }
 
-    // Only trigger once per hold
-    if (!bothHoldArmed && (now - bothPressedSinceMs >= BOTH_HOLD_MS))
-    {
-      bothHoldArmed = true;
-      openDriveSelectWindow();
-      // If you later want "both hold to go to N from anywhere", do it here.
-    }
+  // --- 2) Selection window: N -> D/R within SELECT_WINDOW_MS ---
+  // Judged by when the press happened, not when it got here
+  if (!selectWindowActive || e.gesture != IN_PRESS)
+    return;
+  if ((uint16_t)(e.tMs - selectWindowStartMs) > SELECT_WINDOW_MS)
+  {
+    selectWindowActive = false; // window expired, stay in N
+    return;
   }
-  else
+  // Only accept a single decision during the window
+  if (e.src == IN_PADDLE_R)
   {
-    // combo released -> reset
-    bothPressedSinceMs = 0;
-    bothHoldArmed = false;
+    vehicle.prnd = PRND_D;
+    selectWindowActive = false;
   }
-
-  // --- 2) Selection window: N -> D/R within 500ms after P->N ---
-  if (selectWindowActive)
+  else if (e.src == IN_PADDLE_L)
   {
-    if (now - selectWindowStartMs > SELECT_WINDOW_MS)
-    {
-      selectWindowActive = false; // window expired, stay in N
-    }
-    else
-    {
-      // Only accept a single decision during the window
-      if (rightPressedEdge)
-      {
-        vehicle.prnd = PRND_D;
-        selectWindowActive = false;
-      }
-      else if (leftPressedEdge)
-      {
-        vehicle.prnd = PRND_R;
-        selectWindowActive = false;
-      }
-    }
-    return; // while in window, ignore other paddle functions
+    vehicle.prnd = PRND_R;
+    selectWindowActive = false;
   }
   // --- 3) Outside the window: paddles can do other actions ---
   // Example: if in D, use paddles for +/- shifting (optional)
-  // if (prnd == PRND_D) { if (rightPressedEdge) upshift(); if (leftPressedEdge) downshift(); }
+  // if (prnd == PRND_D) { if (e.src == IN_PADDLE_R) upshift(); if (e.src == IN_PADDLE_L) downshift(); }
+}
 
-  // Or allow N -> D/R anytime by a single press (optional, NOT what you asked)
-  // if (prnd == PRND_N) { if (rightPressedEdge) prnd=PRND_D; if (leftPressedEdge) prnd=PRND_R; }
+void updateSelectWindow()
+{
+  if (selectWindowActive && (uint16_t)((uint16_t)millis() - selectWindowStartMs) > SELECT_WINDOW_MS)
+    selectWindowActive = false; // window expired, stay in N
 }
 
 boolean getSelectWindowActive()
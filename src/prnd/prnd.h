@@ -1,4 +1,10 @@
 #pragma once
-void updatePaddles(VehicleState& vehicle, Button& paddleL, Button& paddleR);
+#include "types.h"
+#include "input/input.h"
+
+// Paddle gestures: both-hold opens the select window, then one press picks
+// D (right) or R (left)
+void prnd_input(VehicleState& vehicle, const InputEvent& e);
+void updateSelectWindow(); // closes the select window once SELECT_WINDOW_MS has passed
 void openDriveSelectWindow();
-boolean getSelectWindowActive();
\ No newline at end of file
+boolean getSelectWindowActive();
@@ -0,0 +1,73 @@
+#include "sched.h"
+
+static bool task_due(const SchedTask &t, uint32_t now)
+{
+  return t.resume || (int32_t)(now - t.dueMs) >= 0;
+}
+
+void sched_run(SchedTask *tasks, uint8_t count)
+{
+  uint32_t now = millis();
+
+  SchedTask *next = nullptr;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (task_due(tasks[i], now) && (!next || tasks[i].priority < next->priority))
+      next = &tasks[i];
+  }
+  if (!next)
+    return;
+
+  if (!next->resume && now - next->dueMs > next->deadlineMs)
+  {
+    if (next->misses != 0xFFFF)
+      next->misses++;
+  }
+
+  uint32_t startUs = micros();
+  bool more = next->fn();
+  uint32_t tookUs = micros() - startUs;
+
+  if (tookUs > 0xFFFF)
+    tookUs = 0xFFFF;
+  if (tookUs > next->maxUs)
+    next->maxUs = tookUs;
+  if (tookUs > next->budgetUs && next->overruns != 0xFFFF)
+    next->overruns++;
+
+  // A resumed job keeps its slot; the next period counts from where it began
+  next->resume = more;
+  if (more)
+    return;
+
+  next->dueMs += next->periodMs;
+  if ((int32_t)(now - next->dueMs) >= 0)
+    next->dueMs = now + next->periodMs; // fell behind: skip, don't burst
+}
+
+void sched_report(Print &out, const SchedTask *tasks, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const SchedTask &t = tasks[i];
+    out.print(t.name);
+    out.print(": max ");
+    out.print(t.maxUs);
+    out.print("us/");
+    out.print(t.budgetUs);
+    out.print(" over ");
+    out.print(t.overruns);
+    out.print(" late ");
+    out.println(t.misses);
+  }
+}
+
+void sched_reset_stats(SchedTask *tasks, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    tasks[i].maxUs = 0;
+    tasks[i].overruns = 0;
+    tasks[i].misses = 0;
+  }
+}
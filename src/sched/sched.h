@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// -------- Cooperative fixed-rate scheduler --------
+// Each sched_run() call runs the highest-priority task that is due, then
+// returns to loop(). A task returns true if it has more work; it then stays
+// due and resumes on a later pass, after anything more urgent has run. That
+// is how long jobs (rendering) are cut into chunks that fit budgetUs.
+
+typedef bool (*TaskFn)();
+
+struct SchedTask
+{
+  const char *name;
+  TaskFn fn;
+  uint8_t priority;    // 0 = most urgent
+  uint16_t periodMs;
+  uint16_t deadlineMs; // must start within this of becoming due
+  uint16_t budgetUs;   // longest acceptable single run
+
+  // runtime state
+  uint32_t dueMs;
+  bool resume;
+  uint16_t maxUs;
+  uint16_t overruns; // runs longer than budgetUs
+  uint16_t misses;   // starts later than deadlineMs
+};
+
+#define SCHED_TASK(name, fn, prio, periodMs, deadlineMs, budgetUs) \
+  {name, fn, prio, periodMs, deadlineMs, budgetUs, 0, false, 0, 0, 0}
+
+void sched_run(SchedTask *tasks, uint8_t count);
+void sched_report(Print &out, const SchedTask *tasks, uint8_t count);
+void sched_reset_stats(SchedTask *tasks, uint8_t count);
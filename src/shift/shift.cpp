@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "shift.h"
+#include "config.h"
+#include "ui/ui.h"
+#include "vehicle/stale.h"
+
+#define SHIFT_GEARS 7
+
+// Shift points by DriveMode and gear (1..SHIFT_GEARS); 0 = off.
+// The automatic modes leave it to the gearbox.
+static const uint16_t SHIFT_RPM[][SHIFT_GEARS] PROGMEM = {
+    //  1     2     3     4     5     6     7
+    {0,    0,    0,    0,    0,    0,    0},    // MODE_COMFORT
+    {0,    0,    0,    0,    0,    0,    0},    // MODE_SPORT
+    {6400, 6500, 6600, 6600, 6600, 6600, 6600}, // MODE_SPORTP
+    {6600, 6700, 6800, 6800, 6800, 6800, 6800}, // MODE_MANUAL
+};
+static_assert(sizeof(SHIFT_RPM) / sizeof(SHIFT_RPM[0]) == MODE_MANUAL + 1, "SHIFT_RPM needs a row per DriveMode");
+
+static bool active = false;   // over the shift point (with hysteresis)
+static bool inverted = false; // what the panel shows
+static uint32_t flashStartMs = 0;
+
+static void set_inverted(bool on)
+{
+  inverted = on;
+  ui_display().sendF("c", on ? 0xA7 : 0xA6);
+}
+
+void shift_init()
+{
+  active = false;
+  set_inverted(false);
+}
+
+uint16_t shift_point(const VehicleState &vehicle)
+{
+  if (vehicle.gear < 1 || vehicle.driveMode > MODE_MANUAL)
+    return 0;
+  uint8_t gear = vehicle.gear > SHIFT_GEARS ? SHIFT_GEARS : vehicle.gear;
+  return pgm_read_word(&SHIFT_RPM[vehicle.driveMode][gear - 1]);
+}
+
+bool shift_update(const VehicleState &vehicle, uint32_t nowMs)
+{
+  uint16_t point = shift_point(vehicle);
+  if (!point || (stale_mask() & SIG_BIT(SIG_RPM)))
+    active = false;
+  else if (vehicle.rpm >= point)
+  {
+    if (!active)
+      flashStartMs = nowMs; // light up now, not on the next flash edge
+    active = true;
+  }
+  else if (vehicle.rpm + SHIFT_HYST_RPM < point)
+    active = false;
+
+  // Flash: on for the first SHIFT_FLASH_MS, then off, and so on
+  bool on = active && ((nowMs - flashStartMs) / SHIFT_FLASH_MS) % 2 == 0;
+  if (on == inverted)
+    return false;
+  set_inverted(on);
+  return true;
+}
+
+bool shift_active()
+{
+  return active;
+}
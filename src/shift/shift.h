@@ -0,0 +1,15 @@
+#pragma once
+#include "types.h"
+
+// -------- Shift light --------
+// Flashes the whole panel with the SSD1306 invert command (0xA7/0xA6) as
+// soon as a decode batch puts RPM over the shift point for the current
+// drive mode and gear. It does not touch the frame buffer, so it needs no
+// page render and shows within one CAN task pass.
+
+void shift_init();
+// After every decode batch. Returns true if the panel was switched on
+// or off this call.
+bool shift_update(const VehicleState &vehicle, uint32_t nowMs);
+bool shift_active();              // RPM is over the shift point
+uint16_t shift_point(const VehicleState &vehicle); // 0 = no shift light
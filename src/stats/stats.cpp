@@ -0,0 +1,114 @@
+#include "stats.h"
+#include "config.h"
+
+static_assert(SIG_RPM == 0 && SIG_MAP == 1 && SIG_LAMBDA == 2 && SIG_TPS == 3 &&
+                  SIG_CLT == 4 && SIG_IAT == 5 && SIG_OILP == 6,
+              "CHANNELS is indexed by SignalId");
+
+static const StatsChannelInfo CHANNELS[STATS_COUNT] = {
+    //  name     flags        threshold
+    {"RPM",  STATS_ABOVE, STATS_RPM_HIGH},
+    {"MAP",  STATS_ABOVE, STATS_MAP_HIGH},
+    {"Lam",  STATS_ABOVE, STATS_LAMBDA_LEAN},
+    {"TPS",  STATS_ABOVE, STATS_TPS_HIGH},
+    {"CLT",  STATS_ABOVE, STATS_CLT_HIGH},
+    {"IAT",  STATS_ABOVE, STATS_IAT_HIGH},
+    {"OilP", STATS_BELOW, STATS_OILP_LOW},
+};
+
+static SignalStats blocks[STATS_COUNT];
+static uint32_t lastTickMs = 0;
+
+const StatsChannelInfo &stats_info(SignalId sig)
+{
+  return CHANNELS[sig];
+}
+
+const SignalStats &stats_get(SignalId sig)
+{
+  return blocks[sig];
+}
+
+int16_t stats_mean(SignalId sig)
+{
+  // Round to nearest, also for negative means
+  const int32_t half = (int32_t)1 << (STATS_EWMA_SHIFT - 1);
+  return (blocks[sig].meanAcc + half) >> STATS_EWMA_SHIFT;
+}
+
+void stats_update(SignalId sig, int32_t v)
+{
+  if (sig >= STATS_COUNT)
+    return;
+  int16_t value = v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v;
+
+  SignalStats &s = blocks[sig];
+  const StatsChannelInfo &c = CHANNELS[sig];
+  bool over = (c.flags & STATS_BELOW) ? value < c.threshold : value > c.threshold;
+
+  if (!s.valid)
+  {
+    s.min = s.max = value;
+    s.meanAcc = (int32_t)value << STATS_EWMA_SHIFT;
+    s.valid = true;
+  }
+  else
+  {
+    if (value < s.min)
+      s.min = value;
+    if (value > s.max)
+      s.max = value;
+    s.meanAcc += (int32_t)value - (s.meanAcc >> STATS_EWMA_SHIFT);
+  }
+
+  if (over && !s.over)
+    s.overCount++;
+  s.over = over;
+}
+
+void stats_tick(uint32_t nowMs)
+{
+  uint32_t dt = nowMs - lastTickMs;
+  lastTickMs = nowMs;
+  for (uint8_t i = 0; i < STATS_COUNT; i++)
+    if (blocks[i].over)
+      blocks[i].overMs += dt;
+}
+
+void stats_load(SignalId sig, const SignalStats &saved)
+{
+  if (sig >= STATS_COUNT)
+    return;
+  blocks[sig] = saved;
+  blocks[sig].over = false;
+}
+
+void stats_reset()
+{
+  memset(blocks, 0, sizeof(blocks));
+}
+
+void stats_dump(Print &out)
+{
+  out.println("sig min max mean over_ms over_n");
+  for (uint8_t i = 0; i < STATS_COUNT; i++)
+  {
+    const SignalStats &s = blocks[i];
+    out.print(CHANNELS[i].name);
+    if (!s.valid)
+    {
+      out.println(" -");
+      continue;
+    }
+    out.print(' ');
+    out.print(s.min);
+    out.print(' ');
+    out.print(s.max);
+    out.print(' ');
+    out.print(stats_mean((SignalId)i));
+    out.print(' ');
+    out.print(s.overMs);
+    out.print(' ');
+    out.println(s.overCount);
+  }
+}
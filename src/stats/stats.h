@@ -0,0 +1,51 @@
+#pragma once
+#include <Arduino.h>
+#include "types.h"
+
+// -------- Session statistics --------
+// Min, max, running mean and time past a threshold for each analog signal.
+// The decoder updates them on every sample in O(1), integer only; the mean
+// is an EWMA: mean += (value - mean) / 2^STATS_EWMA_SHIFT per sample.
+// Time past the threshold is added up by stats_tick() instead, so the
+// decode path never reads the clock.
+// Tracked signals are SignalIds 0..STATS_COUNT-1 (RPM through oil pressure).
+#define STATS_COUNT (SIG_OILP + 1)
+
+enum : uint8_t
+{
+  STATS_ABOVE = 0,      // threshold counts values above it
+  STATS_BELOW = 1 << 0, // ... below it (oil pressure)
+};
+
+struct StatsChannelInfo
+{
+  const char *name;
+  uint8_t flags;
+  int16_t threshold;
+};
+
+struct SignalStats
+{
+  int16_t min;
+  int16_t max;
+  int32_t meanAcc;    // mean << STATS_EWMA_SHIFT
+  uint32_t overMs;    // time spent past the threshold
+  uint16_t overCount; // excursions past the threshold
+  bool valid;         // any samples yet
+  bool over;          // last sample was past the threshold
+};
+
+const StatsChannelInfo &stats_info(SignalId sig);
+const SignalStats &stats_get(SignalId sig); // sig < STATS_COUNT
+int16_t stats_mean(SignalId sig);
+
+// value as decoded, clamped to int16_t. Signals past STATS_COUNT are ignored.
+void stats_update(SignalId sig, int32_t value);
+// Call periodically: the time since the last call counts as past the
+// threshold for signals whose latest sample was
+void stats_tick(uint32_t nowMs);
+
+void stats_reset();
+// Blocks saved by persist; a restored channel starts not past its threshold
+void stats_load(SignalId sig, const SignalStats &saved);
+void stats_dump(Print &out);
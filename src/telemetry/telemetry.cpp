@@ -0,0 +1,148 @@
+#include <Arduino.h>
+#include "telemetry.h"
+#include "config.h"
+#include "crc16.h"
+#include "cobs.h"
+#include "vehicle/vehicle.h"
+
+// flags, seq, time, mask, values, crc; at most 5 bytes per varint
+#define RAW_MAX (2 + 5 + 5 + SIG_COUNT * 5 + 2)
+// COBS adds a byte per 254, plus the delimiter
+#define FRAME_MAX (RAW_MAX + RAW_MAX / 254 + 2)
+static_assert(FRAME_MAX <= 255, "frame length is 8-bit");
+
+static bool active = false;
+static int32_t sent[SIG_COUNT]; // values as of the last frame sent
+static uint8_t seq = 0;
+static uint32_t lastFrameMs = 0; // time field base
+static uint32_t nextSampleMs = 0;
+static uint32_t lastKeyMs = 0;
+static bool needKey = true;
+static TelemetryStats stats;
+
+// Frame on its way to the UART
+static uint8_t tx[FRAME_MAX];
+static uint8_t txLen = 0;
+static uint8_t txPos = 0;
+
+// -------- Encoding --------
+
+static uint8_t put_varint(uint8_t *p, uint32_t v)
+{
+  uint8_t n = 0;
+  while (v >= 0x80)
+  {
+    p[n++] = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static uint32_t zigzag(int32_t v)
+{
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+uint8_t telemetry_build_frame(const VehicleState &vehicle, uint32_t nowMs)
+{
+  bool key = needKey || nowMs - lastKeyMs >= TELEMETRY_KEYFRAME_MS;
+
+  SignalMask mask = 0;
+  for (uint8_t s = 0; s < SIG_COUNT; s++)
+    if (key || vehicle_get(vehicle, (SignalId)s) != sent[s])
+      mask |= SIG_BIT(s);
+  if (!mask)
+    return 0;
+
+  uint8_t raw[RAW_MAX];
+  uint8_t n = 0;
+  raw[n++] = (key ? TELEMETRY_FLAG_KEY : 0) | TELEMETRY_VERSION << 4;
+  raw[n++] = seq++;
+  n += put_varint(raw + n, key ? nowMs : nowMs - lastFrameMs);
+  n += put_varint(raw + n, mask);
+  for (uint8_t s = 0; s < SIG_COUNT; s++)
+  {
+    if (!(mask & SIG_BIT(s)))
+      continue;
+    int32_t v = vehicle_get(vehicle, (SignalId)s);
+    n += put_varint(raw + n, zigzag(v - (key ? 0 : sent[s])));
+    sent[s] = v;
+  }
+  uint16_t crc = crc16_ccitt(0xFFFF, raw, n);
+  raw[n++] = crc;
+  raw[n++] = crc >> 8;
+
+  lastFrameMs = nowMs;
+  if (key)
+  {
+    lastKeyMs = nowMs;
+    needKey = false;
+  }
+  txLen = cobs_encode(tx, raw, n);
+  txPos = 0;
+  return txLen;
+}
+
+// -------- Output --------
+
+void telemetry_start()
+{
+  active = true;
+  needKey = true;
+  nextSampleMs = millis();
+  txLen = txPos = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+void telemetry_stop()
+{
+  active = false;
+}
+
+bool telemetry_active()
+{
+  return active;
+}
+
+// Only what the UART buffer takes now; never blocks
+static void pump()
+{
+  int room = Serial.availableForWrite();
+  uint8_t n = txLen - txPos;
+  if (room < n)
+    n = room;
+  if (n)
+  {
+    Serial.write(tx + txPos, n);
+    txPos += n;
+  }
+}
+
+bool telemetry_sending()
+{
+  return txPos < txLen;
+}
+
+bool telemetry_service(const VehicleState &vehicle, uint32_t nowMs)
+{
+  // Stopped: only finish the frame that was going out
+  if (active && (int32_t)(nowMs - nextSampleMs) >= 0)
+  {
+    nextSampleMs = nowMs + TELEMETRY_PERIOD_MS;
+    if (txPos < txLen)
+      stats.skipped++;
+    else if (telemetry_build_frame(vehicle, nowMs))
+    {
+      stats.frames++;
+      stats.bytes += txLen;
+    }
+  }
+  pump();
+  return txPos < txLen;
+}
+
+const TelemetryStats &telemetry_stats()
+{
+  return stats;
+}
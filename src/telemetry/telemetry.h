@@ -0,0 +1,41 @@
+#pragma once
+#include "types.h"
+
+// -------- Telemetry --------
+// Binary VehicleState stream on Serial for a laptop logger
+// (tools/telemetry_decode.py turns it into CSV). Every TELEMETRY_PERIOD_MS
+// a frame carries the fields that changed since the last frame sent:
+//
+//   flags   (u8)   bit 0 keyframe, bits 4-7 protocol version
+//   seq     (u8)   +1 per frame, gaps = frames lost on the host side
+//   time    varint keyframe: millis(); else ms since the previous frame
+//   mask    varint SIG_BIT() of the fields that follow, in SignalId order
+//   values  varint zigzag(value - last sent value); keyframes send every
+//                  field against 0
+//   crc     (u16)  CRC-16/CCITT of all of the above, little endian
+//
+// then COBS-encoded and ended by a 0x00, so a reader can join at any
+// delimiter. Keyframes go out every TELEMETRY_KEYFRAME_MS. A frame is
+// handed to the UART only as fast as its TX buffer frees up; while one is
+// still going out, samples are skipped and their changes ride in the next.
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FLAG_KEY 0x01
+
+void telemetry_start();
+void telemetry_stop(); // no more samples; the frame going out still finishes
+bool telemetry_active();
+bool telemetry_sending(); // a frame is still going out, also after telemetry_stop()
+// Call every pass: samples on schedule while active and feeds the UART.
+// Returns true while a frame is still being sent.
+bool telemetry_service(const VehicleState &vehicle, uint32_t nowMs);
+// Encode the next frame into the TX buffer (wire bytes incl. delimiter)
+uint8_t telemetry_build_frame(const VehicleState &vehicle, uint32_t nowMs);
+
+struct TelemetryStats
+{
+  uint32_t frames;  // frames sent
+  uint32_t skipped; // samples skipped while the UART was busy
+  uint32_t bytes;   // wire bytes
+};
+const TelemetryStats &telemetry_stats();
@@ -1,6 +1,8 @@
 #include "config.h"
 #include "types.h"
 #include <U8g2lib.h>
+#include "ui_common.h"
+#include "vehicle/vehicle.h"
 
 const char *driveModeToShort(DriveMode m)
 {
@@ -42,8 +44,8 @@ const char *gearToStr(int g)
     return "R";
   if (g == 0)
     return "N";
-  static char buf[4];
-  snprintf(buf, sizeof(buf), "%d", g);
+  static char buf[5];
+  formatInt(buf, g);
   return buf;
 }
 
@@ -62,4 +64,72 @@ const char *prndToStr(Prnd p)
   default:
     return "?";
   }
-}
\ No newline at end of file
+}
+char *formatInt(char *buf, int32_t v)
+{
+  uint32_t u = v;
+  if (v < 0)
+  {
+    *buf++ = '-';
+    u = 0 - u;
+  }
+
+  // Digits come out backwards
+  char tmp[10];
+  uint8_t n = 0;
+  do
+  {
+    tmp[n++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+
+  while (n)
+    *buf++ = tmp[--n];
+  *buf = '\0';
+  return buf;
+}
+
+static uint32_t pow10u(uint8_t n)
+{
+  uint32_t p = 1;
+  while (n--)
+    p *= 10;
+  return p;
+}
+
+char *formatFixed(char *buf, int32_t value, uint8_t scale, uint8_t decimals)
+{
+  if (decimals > scale)
+    decimals = scale;
+
+  bool neg = value < 0;
+  uint32_t u = neg ? 0 - (uint32_t)value : value;
+
+  uint32_t drop = pow10u(scale - decimals);
+  u = (u + drop / 2) / drop;
+  if (u == 0)
+    neg = false; // no "-0.0"
+
+  uint32_t unit = pow10u(decimals);
+  if (neg)
+    *buf++ = '-';
+  buf = formatInt(buf, u / unit);
+  if (decimals == 0)
+    return buf;
+
+  *buf++ = '.';
+  uint32_t frac = u % unit;
+  for (uint32_t d = unit / 10; d; d /= 10)
+  {
+    *buf++ = '0' + frac / d;
+    frac %= d;
+  }
+  *buf = '\0';
+  return buf;
+}
+
+char *formatSignal(char *buf, SignalId sig, int32_t value)
+{
+  uint8_t scale = vehicle_scale(sig);
+  return formatFixed(buf, value, scale, scale > 2 ? 2 : scale);
+}
@@ -1,6 +1,40 @@
 #pragma once 
 #include <types.h>
+
+// -------- Dirty tracking --------
+// Widgets declare what they read as a mask: VehicleState fields (SIG_BIT)
+// plus the UI state bits below. A frame is rebuilt only when one changes.
+#define DIRTY_SELECT_WINDOW SIG_BIT(SIG_COUNT)   // getSelectWindowActive()
+#define DIRTY_CLOCK SIG_BIT(SIG_COUNT + 1)       // time-based, every UI_PERIOD_MS
+#define DIRTY_HISTORY SIG_BIT(SIG_COUNT + 2)     // new history_sample()
+
+// Screen area a widget can touch
+struct UiRect
+{
+  int16_t x, y;
+  uint8_t w, h;
+};
+
+// A widget's dependencies and the area to resend when they change
+struct UiWidgetArea
+{
+  SignalMask deps;
+  UiRect rect;
+};
+
 const char *driveModeToShort(DriveMode m);
 const char *driveModeToText(DriveMode m);
 const char *gearToStr(int g);
 const char *prndToStr(Prnd p);
+
+// -------- Number formatting --------
+// Integer only, so no printf or float code gets linked. Both write a
+// NUL-terminated string and return a pointer to the NUL for chaining;
+// 12 chars hold any int32_t.
+char *formatInt(char *buf, int32_t v);
+// value has `scale` decimal digits (lambda 943, 3 -> 0.943); shows
+// `decimals` of them, rounded half away from zero
+char *formatFixed(char *buf, int32_t value, uint8_t scale, uint8_t decimals);
+// A VehicleState field for display, at most two decimals (lambda 0.94,
+// oil 3.5)
+char *formatSignal(char *buf, SignalId sig, int32_t value);
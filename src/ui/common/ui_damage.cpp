@@ -0,0 +1,156 @@
+#include "ui_damage.h"
+#include "config.h"
+
+#define TILE_COLS UI_TILE_COLS
+#define TILE_ROWS UI_TILE_ROWS
+#define NO_DAMAGE 0xFF
+
+static uint8_t spanMin[TILE_ROWS] = {NO_DAMAGE, NO_DAMAGE, NO_DAMAGE, NO_DAMAGE,
+                                     NO_DAMAGE, NO_DAMAGE, NO_DAMAGE, NO_DAMAGE};
+static uint8_t spanMax[TILE_ROWS];
+static bool fullDamage = false;
+static uint16_t sentBytes = 0;
+static uint16_t lastBytes = 0;
+
+void ui_damage_all()
+{
+  fullDamage = true;
+}
+
+static int16_t clamp_tile(int16_t v, int16_t hi)
+{
+  if (v < 0)
+    return 0;
+  if (v > hi)
+    return hi;
+  return v;
+}
+
+void ui_damage_rect(const UiRect &r)
+{
+  if (r.w == 0 || r.h == 0 || r.x + r.w <= 0 || r.y + r.h <= 0)
+    return;
+
+  uint8_t tx0 = clamp_tile(r.x >> 3, TILE_COLS - 1);
+  uint8_t tx1 = clamp_tile((r.x + r.w - 1) >> 3, TILE_COLS - 1);
+  uint8_t ty0 = clamp_tile(r.y >> 3, TILE_ROWS - 1);
+  uint8_t ty1 = clamp_tile((r.y + r.h - 1) >> 3, TILE_ROWS - 1);
+
+  for (uint8_t ty = ty0; ty <= ty1; ty++)
+  {
+    if (spanMin[ty] == NO_DAMAGE)
+    {
+      spanMin[ty] = tx0;
+      spanMax[ty] = tx1;
+      continue;
+    }
+    if (tx0 < spanMin[ty])
+      spanMin[ty] = tx0;
+    if (tx1 > spanMax[ty])
+      spanMax[ty] = tx1;
+  }
+}
+
+bool ui_damage_pending()
+{
+  if (fullDamage)
+    return true;
+  for (uint8_t ty = 0; ty < TILE_ROWS; ty++)
+    if (spanMin[ty] != NO_DAMAGE)
+      return true;
+  return false;
+}
+
+static void expand_full_damage()
+{
+  if (!fullDamage)
+    return;
+  for (uint8_t ty = 0; ty < TILE_ROWS; ty++)
+  {
+    spanMin[ty] = 0;
+    spanMax[ty] = TILE_COLS - 1;
+  }
+  fullDamage = false;
+}
+
+bool ui_damage_flush(U8G2 &d, uint16_t budgetUs)
+{
+  expand_full_damage();
+
+  uint32_t startUs = micros();
+  uint8_t ty = 0;
+  while (ty < TILE_ROWS)
+  {
+    if (spanMin[ty] == NO_DAMAGE)
+    {
+      ty++;
+      continue;
+    }
+    if (micros() - startUs >= budgetUs)
+      return true; // out of time, resume from this row next slice
+
+    // Rows with the same span go out as one taller area
+    uint8_t th = 1;
+    while (th < UI_FLUSH_MAX_ROWS && ty + th < TILE_ROWS &&
+           spanMin[ty + th] == spanMin[ty] && spanMax[ty + th] == spanMax[ty])
+      th++;
+    uint8_t tw = spanMax[ty] - spanMin[ty] + 1;
+    d.updateDisplayArea(spanMin[ty], ty, tw, th);
+    sentBytes += (uint16_t)tw * th * 8;
+
+    for (uint8_t i = 0; i < th; i++)
+      spanMin[ty + i] = NO_DAMAGE;
+    ty += th;
+  }
+
+  ui_damage_end_frame();
+  return false;
+}
+
+bool ui_damage_band_pending(uint8_t ty, uint8_t rows)
+{
+  expand_full_damage();
+  for (uint8_t i = ty; i < ty + rows && i < TILE_ROWS; i++)
+    if (spanMin[i] != NO_DAMAGE)
+      return true;
+  return false;
+}
+
+void ui_damage_flush_band(U8G2 &d)
+{
+  expand_full_damage();
+
+  uint8_t band = d.getBufferCurrTileRow();
+  uint8_t rows = d.getBufferTileHeight();
+  uint8_t *buf = d.getBufferPtr();
+  for (uint8_t r = 0; r < rows && band + r < TILE_ROWS; r++)
+  {
+    uint8_t ty = band + r;
+    if (spanMin[ty] == NO_DAMAGE)
+      continue;
+    // updateDisplayArea() only works with a full buffer; send the tiles
+    // straight from the band
+    uint8_t tw = spanMax[ty] - spanMin[ty] + 1;
+    u8x8_DrawTile(d.getU8x8(), spanMin[ty], ty, tw, buf + r * TILE_COLS * 8 + spanMin[ty] * 8);
+    sentBytes += (uint16_t)tw * 8;
+    spanMin[ty] = NO_DAMAGE;
+  }
+}
+
+void ui_damage_end_frame()
+{
+  lastBytes = sentBytes;
+  sentBytes = 0;
+}
+
+bool ui_rect_in_band(U8G2 &d, const UiRect &r)
+{
+  int16_t top = d.getBufferCurrTileRow() * 8;
+  int16_t bottom = top + d.getBufferTileHeight() * 8;
+  return r.y < bottom && r.y + r.h > top;
+}
+
+uint16_t ui_damage_last_bytes()
+{
+  return lastBytes;
+}
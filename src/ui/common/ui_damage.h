@@ -0,0 +1,29 @@
+#pragma once
+#include <U8g2lib.h>
+#include "ui_common.h"
+
+// -------- Damaged tile tracking --------
+// The SSD1306 is written in 8x8 px tiles (16 columns x 8 rows). Damage is
+// kept as one span of tile columns per tile row; ui_damage_flush() sends
+// only those spans instead of the whole 1 KB buffer, in bursts of at most
+// UI_FLUSH_MAX_ROWS rows so it can stop when its time budget runs out.
+
+#define UI_TILE_COLS 16
+#define UI_TILE_ROWS 8
+
+void ui_damage_all();
+void ui_damage_rect(const UiRect &r);
+bool ui_damage_pending();
+bool ui_damage_flush(U8G2 &d, uint16_t budgetUs); // true = more to send
+uint16_t ui_damage_last_bytes(); // display data bytes of the last complete frame
+
+// -------- Page-buffer mode --------
+// The buffer holds one band of tile rows at a time, so each band is drawn
+// and sent on its own.
+bool ui_damage_band_pending(uint8_t ty, uint8_t rows);
+void ui_damage_flush_band(U8G2 &d); // damaged spans of the band in the buffer
+void ui_damage_end_frame();         // after the last band
+
+// Widgets skip drawing when their area is outside the band in the buffer
+// (always inside in full-buffer mode)
+bool ui_rect_in_band(U8G2 &d, const UiRect &r);
@@ -0,0 +1,246 @@
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "ui_layout.h"
+#include "ui_damage.h"
+#include "ui_sprite.h"
+#include "ui_text.h"
+#include "amg_logo.h"
+#include "../ui.h"
+#include "../pages/page_main.h"
+#include "../pages/page_stats.h"
+#include "../pages/page_debug.h"
+#include "vehicle/vehicle.h"
+
+// Bar text font, as drawProgressBarWithInvertedText() uses
+#define BAR_FONT u8g2_font_6x10_tf
+
+static void read_widget(const UiPage &page, uint8_t i, UiWidget &w)
+{
+  memcpy_P(&w, &page.widgets[i], sizeof(w));
+}
+
+static void read_rect(const UiPage &page, uint8_t i, UiRect &r)
+{
+  memcpy_P(&r, &page.widgets[i].area.rect, sizeof(r));
+}
+
+static bool rects_overlap(const UiRect &a, const UiRect &b)
+{
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static int32_t widget_value(const UiWidget &w, const VehicleState &vehicle)
+{
+  return vehicle_get(vehicle, w.sig) + w.offset;
+}
+
+// "label value unit", from PROGMEM label and unit
+static void format_value(char *buf, const UiWidget &w, const VehicleState &vehicle)
+{
+  char *p = buf;
+  if (w.label)
+  {
+    strcpy_P(p, w.label);
+    p += strlen(p);
+  }
+  p = formatFixed(p, widget_value(w, vehicle), vehicle_scale(w.sig), w.decimals);
+  if (w.unit)
+    strcpy_P(p, w.unit);
+}
+
+// "label value unit" for a readout
+static void format_readout(char *buf, const UiWidget &w)
+{
+  char *p = buf;
+  if (w.label)
+  {
+    strcpy_P(p, w.label);
+    p += strlen(p);
+  }
+  p = formatInt(p, w.read());
+  if (w.unit)
+    strcpy_P(p, w.unit);
+}
+
+// scroll: the plot is in the buffer as of f.chartScroll columns ago
+static void draw_widget(U8G2 &d, const UiWidget &w, const UiFrameState &f, bool scroll)
+{
+  const UiRect &r = w.area.rect;
+  char txt[UI_WIDGET_TEXT_MAX];
+  switch (w.type)
+  {
+  case UI_W_LABEL:
+    strcpy_P(txt, w.label);
+    d.setFont(w.font);
+    d.drawStr(r.x, UI_TEXT_BASELINE(r), txt);
+    break;
+  case UI_W_VALUE:
+    format_value(txt, w, f.vehicle);
+    d.setFont(w.font);
+    d.drawStr(r.x, UI_TEXT_BASELINE(r), txt);
+    break;
+  case UI_W_BAR:
+    format_value(txt, w, f.vehicle);
+    drawProgressBarWithInvertedText(r.x, r.y, r.w, r.h, widget_value(w, f.vehicle), w.min, w.max, txt);
+    break;
+  case UI_W_LAMBDA:
+    drawLambdaLine(r.x, r.y, r.w, r.h, f.vehicle.lambda, w.min, w.max);
+    break;
+  case UI_W_ODOMETER:
+    drawOdometerCentered(d, vehicle_get(f.vehicle, w.sig), UI_TEXT_BASELINE(r));
+    break;
+  case UI_W_DRIVE_MODE:
+    drawDriveMode(d, f.vehicle, r.x + 12, r.y + 2, false);
+    break;
+  case UI_W_PRND:
+    drawPRND(d, f.vehicle.prnd, r.x, r.y + 7, f.selectWindow);
+    break;
+  case UI_W_GEAR:
+    drawActualGear(d, f.vehicle.gear, r.y);
+    break;
+  case UI_W_LOGO:
+    d.drawXBMP(r.x, r.y, r.w, r.h, amg_bits_small);
+    break;
+  case UI_W_CHART_HEADER:
+    drawChartHeader(d, f.chartChannel, f.vehicle);
+    break;
+  case UI_W_CHART_PLOT:
+    if (scroll)
+      scrollChart(d, f.chartChannel, r, f.history, f.chartScroll);
+    else
+      drawChart(d, f.chartChannel, r, f.history);
+    break;
+  case UI_W_READOUT:
+    format_readout(txt, w);
+    d.setFont(w.font);
+    d.drawStr(r.x, UI_ROW_BASELINE(r), txt);
+    break;
+  case UI_W_PERF_ROW:
+    drawPerfRow(d, r, (PerfStage)w.index);
+    break;
+  case UI_W_STATS_ROW:
+    drawStatsRow(d, r, w.sig);
+    break;
+  }
+}
+
+UiWidgetSet ui_layout_damage(const UiPage &page, SignalMask changed)
+{
+  UiWidgetSet set = 0;
+  for (uint8_t i = 0; i < page.count; i++)
+  {
+    UiWidgetArea area;
+    memcpy_P(&area, &page.widgets[i].area, sizeof(area));
+    if (area.deps & changed)
+    {
+      ui_damage_rect(area.rect);
+      set |= (UiWidgetSet)1 << i;
+    }
+  }
+  return set;
+}
+
+// Draw the widgets in set in table order, then grey out the stale ones
+static void draw_widgets(U8G2 &d, const UiPage &page, const UiFrameState &f, UiWidgetSet set, bool scroll)
+{
+  UiWidget w;
+  for (uint8_t i = 0; i < page.count; i++)
+  {
+    if (!(set & ((UiWidgetSet)1 << i)))
+      continue;
+    read_widget(page, i, w);
+    if (!ui_rect_in_band(d, w.area.rect))
+      continue;
+    const UiRect &r = w.area.rect;
+    d.setClipWindow(r.x, r.y, r.x + r.w, r.y + r.h);
+    draw_widget(d, w, f, scroll);
+  }
+  d.setMaxClipWindow();
+  if (!f.stale)
+    return;
+  for (uint8_t i = 0; i < page.count; i++)
+  {
+    if (!(set & ((UiWidgetSet)1 << i)))
+      continue;
+    UiWidgetArea area;
+    memcpy_P(&area, &page.widgets[i].area, sizeof(area));
+    if (area.deps & f.stale)
+      ui_dim(d, area.rect);
+  }
+}
+
+void ui_layout_draw(U8G2 &d, const UiPage &page, const UiFrameState &f)
+{
+  draw_widgets(d, page, f, UI_ALL_WIDGETS, false);
+}
+
+// Clearing a widget's area takes out whatever overlaps it too, and drawing
+// it again can cover what overlaps it; replaying everything connected to
+// the changed widgets by overlap, in table order, gives back the frame a
+// full redraw would. The chart plot scrolls in place instead of being
+// cleared, so nothing may overlap it.
+void ui_layout_update(U8G2 &d, const UiPage &page, const UiFrameState &f, UiWidgetSet changed)
+{
+  UiWidgetSet redraw = changed;
+  for (bool grew = true; grew;)
+  {
+    grew = false;
+    for (uint8_t i = 0; i < page.count; i++)
+    {
+      UiWidgetSet bit = (UiWidgetSet)1 << i;
+      if (redraw & bit)
+        continue;
+      UiRect ri;
+      read_rect(page, i, ri);
+      for (uint8_t j = 0; j < page.count; j++)
+      {
+        UiRect rj;
+        if (!(redraw & ((UiWidgetSet)1 << j)))
+          continue;
+        read_rect(page, j, rj);
+        if (rects_overlap(ri, rj))
+        {
+          redraw |= bit;
+          grew = true;
+          break;
+        }
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < page.count; i++)
+  {
+    if (!(changed & ((UiWidgetSet)1 << i)) || pgm_read_byte(&page.widgets[i].type) == UI_W_CHART_PLOT)
+      continue;
+    UiRect r;
+    read_rect(page, i, r);
+    ui_clear(d, r);
+  }
+
+  draw_widgets(d, page, f, redraw, true);
+}
+
+void ui_layout_prewarm(U8G2 &d)
+{
+  UiWidget w;
+  char txt[UI_WIDGET_TEXT_MAX];
+  for (uint8_t p = 0; p < PAGE_COUNT; p++)
+  {
+    for (uint8_t i = 0; i < PAGE_LAYOUTS[p].count; i++)
+    {
+      read_widget(PAGE_LAYOUTS[p], i, w);
+      if (w.type != UI_W_BAR)
+        continue;
+      if (w.label)
+      {
+        strcpy_P(txt, w.label);
+        ui_text_width(d, BAR_FONT, txt);
+      }
+      if (w.unit)
+      {
+        strcpy_P(txt, w.unit);
+        ui_text_width(d, BAR_FONT, txt);
+      }
+    }
+  }
+}
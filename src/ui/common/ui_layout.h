@@ -0,0 +1,123 @@
+#pragma once
+#include "types.h"
+#include "ui_common.h"
+#include "history/history.h"
+#include "../pages/page_chart.h"
+
+class U8G2;
+
+// -------- Declarative pages --------
+// A page is a PROGMEM table of widget descriptors (src/ui/pages/page_layouts.cpp),
+// drawn by one loop in table order. The descriptor's area drives everything
+// else: page-buffer band clipping, damage when its deps change, and greying
+// out when one of its signals goes stale.
+//
+// With a full frame buffer the previous frame of the same page is still in
+// the buffer, so an update clears only the areas of widgets whose deps
+// changed and redraws what overlaps them, instead of the whole page. Widgets
+// therefore must not draw outside their area; each is drawn with the U8g2
+// clip window set to it.
+
+enum UiWidgetType : uint8_t
+{
+  UI_W_LABEL,        // label text
+  UI_W_VALUE,        // label, signal value, unit
+  UI_W_BAR,          // bar over [min, max] with "label value unit" inverted on it
+  UI_W_LAMBDA,       // marker over [min, max] with the stoich line
+  UI_W_ODOMETER,     // km, centered, with unit
+  UI_W_DRIVE_MODE,
+  UI_W_PRND,
+  UI_W_GEAR,
+  UI_W_LOGO,         // small AMG logo
+  UI_W_CHART_HEADER, // channel name and value
+  UI_W_CHART_PLOT,   // history plot; scrolled in place on updates
+  UI_W_READOUT,      // label, read() value, unit
+  UI_W_PERF_ROW,     // perf stage index: name, avg, p99, max
+  UI_W_STATS_ROW,    // stats channel: name, min, max, mean, time past
+};
+
+typedef int32_t (*UiReadFn)();
+
+struct UiWidget
+{
+  UiWidgetType type;
+  SignalId sig;       // bound signal, SIG_COUNT if none
+  UiWidgetArea area;  // deps and the area drawn into
+  const uint8_t *font;
+  const char *label;  // PROGMEM, or nullptr
+  const char *unit;   // PROGMEM, or nullptr
+  uint8_t decimals;   // of the signal's fixed point shown
+  int16_t offset;     // added to the value first (boost = MAP - 100)
+  int16_t min, max;   // bar and marker range, after offset
+  UiReadFn read;      // UI_W_READOUT value
+  uint8_t index;      // UI_W_PERF_ROW stage
+};
+
+// Label, value and unit are built in one buffer; the page checks hold every
+// table's texts to it
+#define UI_VALUE_CHARS_MAX 12 // formatFixed() of any int32_t, sign and point included
+#define UI_WIDGET_TEXT_MAX (8 + UI_VALUE_CHARS_MAX + 8 + 1)
+
+// Text widgets draw on the baseline 3 px above the area's bottom edge,
+// leaving room for descenders
+#define UI_TEXT_BASELINE(r) ((r).y + (r).h - 3)
+// Readouts and table rows are 5x7 text, one pixel of descender below the
+// baseline, so 7 px rows can stack without a gap
+#define UI_ROW_BASELINE(r) ((r).y + (r).h - 2)
+
+// -------- Table entries --------
+// The area goes last, as {x, y, w, h} or one of the *_RECT macros
+#define UI_LABEL(font, label, ...) \
+  { UI_W_LABEL, SIG_COUNT, {0, __VA_ARGS__}, font, label, nullptr, 0, 0, 0, 0, nullptr, 0 }
+#define UI_VALUE(sig, font, label, unit, decimals, offset, ...) \
+  { UI_W_VALUE, sig, {SIG_BIT(sig), __VA_ARGS__}, font, label, unit, decimals, offset, 0, 0, nullptr, 0 }
+#define UI_BAR(sig, label, unit, offset, min, max, ...) \
+  { UI_W_BAR, sig, {SIG_BIT(sig), __VA_ARGS__}, nullptr, label, unit, 0, offset, min, max, nullptr, 0 }
+#define UI_LAMBDA(min, max, ...) \
+  { UI_W_LAMBDA, SIG_LAMBDA, {SIG_BIT(SIG_LAMBDA), __VA_ARGS__}, nullptr, nullptr, nullptr, 0, 0, min, max, nullptr, 0 }
+// Counters and rows that follow the clock rather than a signal
+#define UI_READOUT(font, label, read, unit, ...) \
+  { UI_W_READOUT, SIG_COUNT, {DIRTY_CLOCK, __VA_ARGS__}, font, label, unit, 0, 0, 0, 0, read, 0 }
+#define UI_PERF_ROW(stage, ...) \
+  { UI_W_PERF_ROW, SIG_COUNT, {DIRTY_CLOCK, __VA_ARGS__}, nullptr, nullptr, nullptr, 0, 0, 0, 0, nullptr, stage }
+#define UI_STATS_ROW(sig, ...) \
+  { UI_W_STATS_ROW, sig, {DIRTY_CLOCK, __VA_ARGS__}, nullptr, nullptr, nullptr, 0, 0, 0, 0, nullptr, 0 }
+// Widgets that draw themselves, with the deps of their *_DEPS macro
+#define UI_WIDGET(type, sig, deps, ...) \
+  { type, sig, {deps, __VA_ARGS__}, nullptr, nullptr, nullptr, 0, 0, 0, 0, nullptr, 0 }
+
+struct UiPage
+{
+  const UiWidget *widgets; // PROGMEM
+  uint8_t count;
+};
+
+#define UI_PAGE(table) {table, sizeof(table) / sizeof(table[0])}
+#define UI_PAGE_MAX_WIDGETS 32 // one bit each in a UiWidgetSet
+
+typedef uint32_t UiWidgetSet; // bit i = widget i of a page
+#define UI_ALL_WIDGETS 0xFFFFFFFFUL
+
+extern const UiPage PAGE_LAYOUTS[PAGE_COUNT];
+
+// What widgets read, as of when the frame began
+struct UiFrameState
+{
+  VehicleState vehicle;
+  bool selectWindow;
+  SignalMask stale;
+  HistChannel chartChannel;
+  ChartWindow history;
+  uint16_t chartScroll; // update: columns the plot moves since it was drawn
+  uint8_t page;
+};
+
+// Damage the areas of widgets that read something in changed; returns them
+UiWidgetSet ui_layout_damage(const UiPage &page, SignalMask changed);
+// The whole page, into a cleared buffer (the current band in page-buffer mode)
+void ui_layout_draw(U8G2 &d, const UiPage &page, const UiFrameState &f);
+// Full buffer holding this page's last frame: redraw the changed widgets
+// and whatever overlaps them
+void ui_layout_update(U8G2 &d, const UiPage &page, const UiFrameState &f, UiWidgetSet changed);
+// Label widths of every page, so the first frames don't measure
+void ui_layout_prewarm(U8G2 &d);
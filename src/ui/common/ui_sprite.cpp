@@ -0,0 +1,85 @@
+#include "ui_sprite.h"
+#include <U8g2lib.h>
+#include "ui_common.h"
+
+void ui_blit(U8G2 &d, int16_t x, int16_t y, const uint8_t *bits, uint8_t w, uint8_t h, bool opaque)
+{
+  uint8_t *buf = d.getBufferPtr();
+  int16_t bufW = d.getBufferTileWidth() * 8;
+  int16_t bandTop = d.getBufferCurrTileRow() * 8;
+  int8_t bandPages = d.getBufferTileHeight();
+
+  // Columns on screen
+  uint8_t c0 = x < 0 ? -x : 0;
+  uint8_t c1 = x + w > bufW ? bufW - x : w;
+  if (x >= bufW || c0 >= c1)
+    return;
+
+  uint8_t pages = (h + 7) >> 3;
+  for (uint8_t sp = 0; sp < pages; sp++)
+  {
+    uint8_t rows = h - sp * 8;
+    uint8_t mask = rows >= 8 ? 0xFF : (1 << rows) - 1;
+
+    // Sprite page lands across buffer pages p and p + 1
+    int16_t top = y + sp * 8 - bandTop;
+    int8_t p = top >> 3; // floor, also for negative top
+    uint8_t shift = top & 7;
+    if (p >= bandPages || p + 1 < 0)
+      continue;
+
+    uint16_t mask16 = (uint16_t)mask << shift;
+    uint8_t maskLo = mask16, maskHi = mask16 >> 8;
+    uint8_t *lo = p >= 0 ? buf + p * bufW : nullptr;
+    uint8_t *hi = (p + 1 < bandPages && maskHi) ? buf + (p + 1) * bufW : nullptr;
+    const uint8_t *src = bits + sp * w;
+
+    for (uint8_t c = c0; c < c1; c++)
+    {
+      uint16_t b = (uint16_t)(pgm_read_byte(src + c) & mask) << shift;
+      int16_t col = x + c;
+      if (lo)
+        lo[col] = opaque ? (lo[col] & ~maskLo) | (uint8_t)b : lo[col] | (uint8_t)b;
+      if (hi)
+        hi[col] = opaque ? (hi[col] & ~maskHi) | (uint8_t)(b >> 8) : hi[col] | (uint8_t)(b >> 8);
+    }
+  }
+}
+
+// Clear the pixels of r selected by the checkerboard: even columns lose
+// the rows in evenMask, odd columns those in oddMask
+static void clear_rect(U8G2 &d, const UiRect &r, uint8_t evenMask, uint8_t oddMask)
+{
+  uint8_t *buf = d.getBufferPtr();
+  int16_t bufW = d.getBufferTileWidth() * 8;
+  int16_t bandTop = d.getBufferCurrTileRow() * 8;
+  int16_t bandBottom = bandTop + d.getBufferTileHeight() * 8;
+
+  int16_t x0 = r.x < 0 ? 0 : r.x;
+  int16_t x1 = r.x + r.w > bufW ? bufW : r.x + r.w;
+  int16_t y0 = r.y < bandTop ? bandTop : r.y;
+  int16_t y1 = r.y + r.h > bandBottom ? bandBottom : r.y + r.h;
+
+  for (int16_t y = y0; y < y1;)
+  {
+    // Rows y..yEnd-1 share a buffer page
+    int16_t yEnd = ((y >> 3) + 1) << 3;
+    if (yEnd > y1)
+      yEnd = y1;
+    uint8_t rows = (0xFF << (y & 7)) & (0xFF >> (8 - ((yEnd - 1) & 7) - 1));
+    uint8_t *row = buf + ((y - bandTop) >> 3) * bufW;
+    for (int16_t x = x0; x < x1; x++)
+      row[x] &= ~(rows & ((x & 1) ? oddMask : evenMask));
+    y = yEnd;
+  }
+}
+
+void ui_dim(U8G2 &d, const UiRect &r)
+{
+  clear_rect(d, r, 0x55, 0xAA);
+}
+
+void ui_clear(U8G2 &d, const UiRect &r)
+{
+  clear_rect(d, r, 0xFF, 0xFF);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+
+class U8G2;
+
+// -------- Sprites --------
+// Copies a prerendered sprite (src/sprites.h, PROGMEM) straight into the
+// frame buffer, a column byte at a time, instead of going through the font
+// or XBM pixel paths. Clipped to the screen and to the buffer's current
+// page band. opaque: sprite rect replaces what's there; otherwise set bits
+// are ORed in. Always draws in color 1.
+void ui_blit(U8G2 &d, int16_t x, int16_t y, const uint8_t *bits, uint8_t w, uint8_t h, bool opaque);
+
+// -------- Dimming --------
+// Clears every other pixel of a screen area in a checkerboard, so what is
+// drawn there reads as greyed out. Same clipping as ui_blit().
+struct UiRect;
+void ui_dim(U8G2 &d, const UiRect &r);
+// Clears a screen area a buffer byte at a time, where drawBox() in color 0
+// goes a pixel row at a time
+void ui_clear(U8G2 &d, const UiRect &r);
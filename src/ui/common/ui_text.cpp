@@ -0,0 +1,160 @@
+#include "ui_text.h"
+#include <U8g2lib.h>
+#include "config.h"
+
+// getStrWidth() trims the last glyph to its ink, so a string's width is the
+// advance of all but its last glyph plus the last glyph's own width. Runs are
+// stored the same way: `adv` when more text follows, `width` when it ends.
+
+// -------- Digit metrics --------
+static const char NUM_CHARS[] = "0123456789-.";
+#define NUM_CHAR_COUNT (sizeof(NUM_CHARS) - 1)
+
+struct DigitMetrics
+{
+  const uint8_t *font;
+  uint8_t adv[NUM_CHAR_COUNT];
+  uint8_t width[NUM_CHAR_COUNT];
+};
+
+static DigitMetrics digitFonts[UI_TEXT_DIGIT_FONTS];
+static uint8_t digitFontCount = 0;
+
+// -------- Label cache --------
+struct LabelEntry
+{
+  const uint8_t *font;
+  uint8_t len;
+  uint8_t adv;
+  uint8_t width;
+  char text[UI_TEXT_MAX_LABEL]; // runs come from stack buffers too, so not a pointer
+};
+
+static LabelEntry labels[UI_TEXT_CACHE_SIZE];
+static uint8_t labelCount = 0;
+static uint8_t labelNext = 0; // round-robin victim once full
+
+static int8_t num_index(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c == '-')
+    return 10;
+  if (c == '.')
+    return 11;
+  return -1;
+}
+
+// Measure with font, leaving the caller's font selected
+static uint8_t measure(U8G2 &d, const uint8_t *font, const char *s)
+{
+  const uint8_t *prev = d.getU8g2()->font;
+  d.setFont(font);
+  uint8_t w = d.getStrWidth(s);
+  if (prev)
+    d.setFont(prev);
+  return w;
+}
+
+static const DigitMetrics *digit_metrics(const uint8_t *font)
+{
+  for (uint8_t i = 0; i < digitFontCount; i++)
+    if (digitFonts[i].font == font)
+      return &digitFonts[i];
+  return nullptr;
+}
+
+void ui_text_number_font(U8G2 &d, const uint8_t *font)
+{
+  if (digit_metrics(font) || digitFontCount >= UI_TEXT_DIGIT_FONTS)
+    return;
+
+  DigitMetrics &m = digitFonts[digitFontCount++];
+  m.font = font;
+  const uint8_t *prev = d.getU8g2()->font;
+  d.setFont(font);
+  char one[2] = {0, 0};
+  char pair[3] = {0, '0', 0};
+  uint8_t zero = d.getStrWidth("0");
+  for (uint8_t i = 0; i < NUM_CHAR_COUNT; i++)
+  {
+    one[0] = pair[0] = NUM_CHARS[i];
+    m.width[i] = d.getStrWidth(one);
+    m.adv[i] = d.getStrWidth(pair) - zero;
+  }
+  if (prev)
+    d.setFont(prev);
+}
+
+static const LabelEntry &label_metrics(U8G2 &d, const uint8_t *font, const char *s, uint8_t len)
+{
+  for (uint8_t i = 0; i < labelCount; i++)
+  {
+    const LabelEntry &e = labels[i];
+    if (e.len == len && e.font == font && memcmp(e.text, s, len) == 0)
+      return e;
+  }
+
+  LabelEntry *e;
+  if (labelCount < UI_TEXT_CACHE_SIZE)
+    e = &labels[labelCount++];
+  else
+  {
+    e = &labels[labelNext];
+    labelNext = (labelNext + 1) % UI_TEXT_CACHE_SIZE;
+  }
+
+  // Run plus a trailing '0' gives its advance
+  char buf[UI_TEXT_MAX_LABEL + 2];
+  memcpy(buf, s, len);
+  buf[len] = '\0';
+
+  e->font = font;
+  e->len = len;
+  memcpy(e->text, s, len);
+  e->width = measure(d, font, buf);
+  buf[len] = '0';
+  buf[len + 1] = '\0';
+  e->adv = measure(d, font, buf) - measure(d, font, "0");
+  return *e;
+}
+
+uint8_t ui_text_width(U8G2 &d, const uint8_t *font, const char *s)
+{
+  const DigitMetrics *digits = digit_metrics(font);
+  uint8_t w = 0;
+
+  while (*s)
+  {
+    // Split into alternating number / label runs; long labels are split
+    // too, widths add up the same way
+    bool isNum = digits && num_index(*s) >= 0;
+    const char *end = s + 1;
+    while (*end && (digits && num_index(*end) >= 0) == isNum &&
+           (isNum || end - s < UI_TEXT_MAX_LABEL))
+      end++;
+    bool last = *end == '\0';
+
+    if (isNum)
+    {
+      for (const char *p = s; p < end; p++)
+      {
+        uint8_t k = num_index(*p);
+        w += (last && p + 1 == end) ? digits->width[k] : digits->adv[k];
+      }
+    }
+    else
+    {
+      const LabelEntry &e = label_metrics(d, font, s, end - s);
+      w += last ? e.width : e.adv;
+    }
+    s = end;
+  }
+  return w;
+}
+
+void ui_text_prewarm(U8G2 &d, const uint8_t *font, const char *const *list, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+    ui_text_width(d, font, list[i]);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+
+class U8G2;
+
+// -------- Text measurement --------
+// ui_text_width() returns what U8G2::getStrWidth() would for s in font, but
+// without switching fonts or walking glyph data on the hot path:
+//  - runs of number characters (0-9 - .) add up per-font digit metrics,
+//    for fonts registered with ui_text_number_font()
+//  - any other run (labels, units) is measured once and kept in a small
+//    cache keyed by (font, text)
+// Fonts live in U8g2's PROGMEM tables and can't be read at compile time, so
+// fixed labels are measured up front with ui_text_prewarm() instead.
+uint8_t ui_text_width(U8G2 &d, const uint8_t *font, const char *s);
+
+// Measure digit metrics for a font that shows numbers
+void ui_text_number_font(U8G2 &d, const uint8_t *font);
+
+// Measure fixed labels at init so the first frames don't pay for misses
+void ui_text_prewarm(U8G2 &d, const uint8_t *font, const char *const *labels, uint8_t count);
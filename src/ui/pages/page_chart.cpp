@@ -0,0 +1,84 @@
+#include "config.h"
+#include "types.h"
+#include "vehicle/vehicle.h"
+#include "../common/ui_common.h"
+#include "../common/ui_text.h"
+#include "page_chart.h"
+#include <U8g2lib.h>
+
+void drawChartHeader(U8G2& d, HistChannel ch, const VehicleState &vehicle)
+{
+  const HistChannelInfo &info = history_info(ch);
+
+  d.setFont(CHART_FONT);
+  d.drawStr(0, 10, info.name);
+
+  char num[12];
+  formatSignal(num, info.sig, vehicle_get(vehicle, info.sig));
+  d.drawStr(128 - ui_text_width(d, CHART_FONT, num), 10, num);
+
+  d.drawHLine(0, 13, 128);
+}
+
+// The plot, right of the axis
+static UiRect chart_plot(const UiRect &area)
+{
+  UiRect plot = {(int16_t)(area.x + 1), area.y, (uint8_t)(area.w - 1), area.h};
+  return plot;
+}
+
+static int16_t level_y(const UiRect &plot, uint8_t level)
+{
+  return plot.y + plot.h - 1 - ((uint16_t)level * (plot.h - 1) + 127) / 255;
+}
+
+// Column x shows sample seq: a vertical run from the previous sample's level
+// to this one's, so steep changes stay connected. The reference level is
+// dotted on every 4th sample, which keeps the dots moving with the data.
+static void drawChartColumn(U8G2& d, HistChannel ch, const UiRect &plot, ChartWindow win, int16_t x, uint16_t seq)
+{
+  uint16_t age = win.end - seq; // 1 = newest
+  if (age == 0 || age > win.count)
+    return;
+
+  const HistChannelInfo &info = history_info(ch);
+  if (info.ref > info.min && info.ref < info.max && (seq & 3) == 0)
+    d.drawPixel(x, level_y(plot, history_level(ch, info.ref)));
+
+  int16_t y = level_y(plot, history_at(ch, seq));
+  int16_t prev = age < win.count ? level_y(plot, history_at(ch, seq - 1)) : y;
+  if (prev < y)
+    d.drawVLine(x, prev, y - prev + 1);
+  else
+    d.drawVLine(x, y, prev - y + 1);
+}
+
+void drawChart(U8G2& d, HistChannel ch, const UiRect &area, ChartWindow win)
+{
+  d.drawVLine(area.x, area.y, area.h);
+
+  UiRect plot = chart_plot(area);
+  uint16_t seq = win.end - plot.w;
+  for (uint8_t i = 0; i < plot.w; i++)
+    drawChartColumn(d, ch, plot, win, plot.x + i, seq + i);
+}
+
+void scrollChart(U8G2& d, HistChannel ch, const UiRect &area, ChartWindow win, uint16_t n)
+{
+  UiRect plot = chart_plot(area);
+  if (n > plot.w)
+    n = plot.w;
+
+  uint8_t *buf = d.getBufferPtr();
+  uint8_t bufW = d.getBufferTileWidth() * 8;
+  uint8_t keep = plot.w - n;
+  for (uint8_t p = plot.y >> 3; p < (plot.y + plot.h) >> 3; p++)
+  {
+    uint8_t *row = buf + p * bufW + plot.x;
+    memmove(row, row + n, keep);
+    memset(row + keep, 0, n);
+  }
+
+  for (uint8_t i = 0; i < n; i++)
+    drawChartColumn(d, ch, plot, win, plot.x + keep + i, win.end - n + i);
+}
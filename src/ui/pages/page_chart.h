@@ -0,0 +1,36 @@
+#pragma once
+#include "types.h"
+#include "history/history.h"
+#include "../common/ui_common.h"
+
+class U8G2;
+
+// What the chart page reads (see DIRTY_* in ui_common.h)
+#define CHART_HEADER_DEPS (SIG_BIT(SIG_RPM) | SIG_BIT(SIG_MAP) | SIG_BIT(SIG_LAMBDA) | SIG_BIT(SIG_TPS))
+#define CHART_PLOT_DEPS DIRTY_HISTORY
+
+// Plot on tile row boundaries so it can be scrolled a byte column at a time.
+// The axis takes the first column and the plot the rest: one column
+// narrower than the history, so the oldest column shown still has the
+// sample before it to join up with.
+#define CHART_HEADER_RECT {0, 0, 128, 16}
+#define CHART_PLOT_RECT {0, 16, 128, 48}
+
+#define CHART_FONT u8g2_font_6x10_tf
+
+// Samples shown: the plot's rightmost column is sample end - 1, going back
+// at most count samples (history_seq() and history_count() when the frame
+// began)
+struct ChartWindow
+{
+  uint16_t end;
+  uint8_t count;
+};
+
+void drawChartHeader(U8G2& d, HistChannel ch, const VehicleState &vehicle);
+// Axis, then every column; area is CHART_PLOT_RECT
+void drawChart(U8G2& d, HistChannel ch, const UiRect &area, ChartWindow win);
+// Full buffer only: moves the plot in the buffer n columns left and draws
+// the n new ones on the right (all of it when n fills the plot). The buffer
+// must hold the plot as drawn for samples up to win.end - n.
+void scrollChart(U8G2& d, HistChannel ch, const UiRect &area, ChartWindow win, uint16_t n);
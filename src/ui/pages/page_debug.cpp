@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include "can/canbus.h"
+#include "../common/ui_layout.h"
+#include "page_debug.h"
+#include <U8g2lib.h>
+
+// Age and loss readouts have room for four digits
+#define DEBUG_COUNT_MAX 9999
+
+extern volatile uint32_t lastCanMs;
+
+int32_t debug_fps()
+{
+  return perf_fps();
+}
+
+int32_t debug_free_sram()
+{
+  return perf_free_sram();
+}
+
+int32_t debug_can_rate()
+{
+  return perf_can_rate();
+}
+
+int32_t debug_can_age()
+{
+  uint32_t age = millis() - lastCanMs;
+  return age < DEBUG_COUNT_MAX ? (int32_t)age : DEBUG_COUNT_MAX;
+}
+
+int32_t debug_can_dropped()
+{
+  uint16_t n = can_rx_stats().dropped;
+  return n < DEBUG_COUNT_MAX ? n : DEBUG_COUNT_MAX;
+}
+
+int32_t debug_can_overruns()
+{
+  uint16_t n = can_rx_stats().hwOverruns;
+  return n < DEBUG_COUNT_MAX ? n : DEBUG_COUNT_MAX;
+}
+
+void drawPerfRow(U8G2& d, const UiRect &r, PerfStage stage)
+{
+  int y = UI_ROW_BASELINE(r);
+  char num[12];
+  d.setFont(DEBUG_FONT);
+  d.drawStr(r.x, y, perf_stage_name(stage));
+  formatInt(num, perf_avg_us(stage));
+  d.drawStr(r.x + DEBUG_COL_AVG, y, num);
+  formatInt(num, perf_p99_us(stage));
+  d.drawStr(r.x + DEBUG_COL_P99, y, num);
+  formatInt(num, perf_stats(stage).maxUs);
+  d.drawStr(r.x + DEBUG_COL_MAX, y, num);
+}
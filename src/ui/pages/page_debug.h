@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include "diag/perf.h"
+#include "../common/ui_common.h"
+
+class U8G2;
+
+#define DEBUG_FONT u8g2_font_5x7_tf
+// 7 px rows: two of readouts, the column labels and every perf stage make
+// nine, and 5x7 digits and capitals need no more
+#define DEBUG_ROW_Y(i) (1 + 7 * (i))
+#define DEBUG_PERF_ROW 3 // first perf stage row
+#define DEBUG_PERF_RECT(stage) {0, DEBUG_ROW_Y(DEBUG_PERF_ROW + (stage)), 128, 7}
+#define DEBUG_COL_AVG 35
+#define DEBUG_COL_P99 65
+#define DEBUG_COL_MAX 95
+
+// Readouts for the page table
+int32_t debug_fps();
+int32_t debug_free_sram();
+int32_t debug_can_rate();   // frames/s
+int32_t debug_can_age();    // ms since the last frame, 9999 at most
+int32_t debug_can_dropped();  // lost to a full RX ring, 9999 at most
+int32_t debug_can_overruns(); // MCP2515 RX overruns, 9999 at most
+
+// Stage name, mean, p99 and max in us
+void drawPerfRow(U8G2& d, const UiRect &r, PerfStage stage);
@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "amg_logo.h"
+#include "../common/ui_layout.h"
+#include "page_main.h"
+#include "page_chart.h"
+#include "page_stats.h"
+#include "page_debug.h"
+#include "stats/stats.h"
+
+// -------- Page tables --------
+// One per PageId, drawn in table order. A new page is a table here, an
+// entry in PAGE_LAYOUTS and a PageId.
+
+#define BODY_FONT u8g2_font_6x10_tf
+#define BIG_FONT u8g2_font_helvB14_tf
+
+static constexpr char TXT_SENSORS[] PROGMEM = "Sensors";
+static constexpr char TXT_FUEL[] PROGMEM = "Fuel / Lambda";
+static constexpr char TXT_BOOST[] PROGMEM = "Boost";
+static constexpr char TXT_MAP[] PROGMEM = "MAP ";
+static constexpr char TXT_RPM[] PROGMEM = "RPM ";
+static constexpr char TXT_TPS[] PROGMEM = "TPS ";
+static constexpr char TXT_IAT[] PROGMEM = "IAT ";
+static constexpr char TXT_LAMBDA[] PROGMEM = "Lambda: ";
+static constexpr char TXT_OILP[] PROGMEM = "OilP: ";
+static constexpr char TXT_KPA[] PROGMEM = " kpa";
+static constexpr char TXT_KPA_BIG[] PROGMEM = " kPa"; // no descender below the baseline
+static constexpr char TXT_PCT[] PROGMEM = " %";
+static constexpr char TXT_DEG_C[] PROGMEM = " C";
+static constexpr char TXT_MIN[] PROGMEM = "min";
+static constexpr char TXT_MAX[] PROGMEM = "max";
+static constexpr char TXT_AVG[] PROGMEM = "avg";
+static constexpr char TXT_PAST[] PROGMEM = "past";
+static constexpr char TXT_P99[] PROGMEM = "p99";
+static constexpr char TXT_MAX_US[] PROGMEM = "max us";
+static constexpr char TXT_FPS[] PROGMEM = "fps ";
+static constexpr char TXT_RAM[] PROGMEM = "ram ";
+static constexpr char TXT_RX[] PROGMEM = "rx ";
+static constexpr char TXT_PER_S[] PROGMEM = "/s";
+static constexpr char TXT_AGE[] PROGMEM = "age ";
+static constexpr char TXT_DROP[] PROGMEM = "drop ";
+static constexpr char TXT_OVR[] PROGMEM = "ovr ";
+
+static constexpr UiWidget MAIN_PAGE[] PROGMEM = {
+    UI_WIDGET(UI_W_LOGO,       SIG_COUNT,      0,               {77, 56, AMG_SMALL_W, AMG_SMALL_H}),
+    UI_WIDGET(UI_W_ODOMETER,   SIG_ODO,        ODOMETER_DEPS,   ODOMETER_RECT(18)),
+    UI_WIDGET(UI_W_ODOMETER,   SIG_TRIP,       TRIP_DEPS,       ODOMETER_RECT(30)),
+    UI_WIDGET(UI_W_DRIVE_MODE, SIG_DRIVE_MODE, DRIVE_MODE_DEPS, DRIVE_MODE_RECT(96, 44)),
+    UI_WIDGET(UI_W_PRND,       SIG_PRND,       PRND_DEPS,       PRND_RECT(5, 48)),
+    UI_WIDGET(UI_W_GEAR,       SIG_GEAR,       GEAR_DEPS,       GEAR_RECT(41)),
+};
+
+static constexpr UiWidget SENSORS_PAGE[] PROGMEM = {
+    UI_LABEL(BODY_FONT, TXT_SENSORS,                {0, 1, 128, 12}),
+    UI_BAR(SIG_MAP, TXT_MAP, TXT_KPA, 0, 0, 250,    {0, 39, 128, 11}),
+    UI_BAR(SIG_RPM, TXT_RPM, nullptr, 0, 0, 9000,   {0, 52, 128, 11}),
+    UI_LAMBDA(700, 1240,                            {0, 15, 128, 11}),
+};
+
+static constexpr UiWidget FUEL_PAGE[] PROGMEM = {
+    UI_LABEL(BODY_FONT, TXT_FUEL,                               {0, 1, 128, 12}),
+    UI_VALUE(SIG_LAMBDA, BODY_FONT, TXT_LAMBDA, nullptr, 2, 0,  {0, 19, 128, 12}),
+    UI_VALUE(SIG_OILP, BODY_FONT, TXT_OILP, nullptr, 1, 0,      {0, 35, 128, 12}),
+};
+
+// Boost is MAP over atmospheric, taken as 100 kPa
+static constexpr UiWidget BOOST_PAGE[] PROGMEM = {
+    UI_LABEL(BODY_FONT, TXT_BOOST,                            {0, 1, 64, 12}),
+    UI_VALUE(SIG_IAT, BODY_FONT, TXT_IAT, TXT_DEG_C, 0, 0,    {72, 1, 56, 12}),
+    UI_VALUE(SIG_MAP, BIG_FONT, nullptr, TXT_KPA_BIG, 0, -100, {0, 14, 128, 22}),
+    UI_BAR(SIG_TPS, TXT_TPS, TXT_PCT, 0, 0, 100,              {0, 39, 128, 11}),
+    UI_BAR(SIG_RPM, TXT_RPM, nullptr, 0, 0, 9000,             {0, 52, 128, 11}),
+};
+
+static constexpr UiWidget CHART_PAGE[] PROGMEM = {
+    UI_WIDGET(UI_W_CHART_PLOT,   SIG_COUNT, CHART_PLOT_DEPS,   CHART_PLOT_RECT),
+    UI_WIDGET(UI_W_CHART_HEADER, SIG_COUNT, CHART_HEADER_DEPS, CHART_HEADER_RECT),
+};
+
+// One row per stats channel
+static constexpr UiWidget STATS_PAGE[] PROGMEM = {
+    UI_LABEL(STATS_FONT, TXT_MIN,  {STATS_COL_MIN, 0, 26, STATS_HEADER_H}),
+    UI_LABEL(STATS_FONT, TXT_MAX,  {STATS_COL_MAX, 0, 26, STATS_HEADER_H}),
+    UI_LABEL(STATS_FONT, TXT_AVG,  {STATS_COL_AVG, 0, 26, STATS_HEADER_H}),
+    UI_LABEL(STATS_FONT, TXT_PAST, {STATS_COL_PAST, 0, 26, STATS_HEADER_H}),
+    UI_STATS_ROW(SIG_RPM,    STATS_ROW_RECT(SIG_RPM)),
+    UI_STATS_ROW(SIG_MAP,    STATS_ROW_RECT(SIG_MAP)),
+    UI_STATS_ROW(SIG_LAMBDA, STATS_ROW_RECT(SIG_LAMBDA)),
+    UI_STATS_ROW(SIG_TPS,    STATS_ROW_RECT(SIG_TPS)),
+    UI_STATS_ROW(SIG_CLT,    STATS_ROW_RECT(SIG_CLT)),
+    UI_STATS_ROW(SIG_IAT,    STATS_ROW_RECT(SIG_IAT)),
+    UI_STATS_ROW(SIG_OILP,   STATS_ROW_RECT(SIG_OILP)),
+};
+
+// Readouts, then one row per perf stage. The column labels take the
+// label baseline, so they reach one pixel into the first perf row's area.
+static constexpr UiWidget DEBUG_PAGE[] PROGMEM = {
+    UI_READOUT(DEBUG_FONT, TXT_FPS, debug_fps, nullptr,          {0, DEBUG_ROW_Y(0), 40, 7}),
+    UI_READOUT(DEBUG_FONT, TXT_RAM, debug_free_sram, nullptr,    {40, DEBUG_ROW_Y(0), 43, 7}),
+    UI_READOUT(DEBUG_FONT, TXT_RX, debug_can_rate, TXT_PER_S,    {83, DEBUG_ROW_Y(0), 45, 7}),
+    UI_READOUT(DEBUG_FONT, TXT_AGE, debug_can_age, nullptr,      {0, DEBUG_ROW_Y(1), 40, 7}),
+    UI_READOUT(DEBUG_FONT, TXT_DROP, debug_can_dropped, nullptr, {40, DEBUG_ROW_Y(1), 45, 7}),
+    UI_READOUT(DEBUG_FONT, TXT_OVR, debug_can_overruns, nullptr, {85, DEBUG_ROW_Y(1), 43, 7}),
+    UI_LABEL(DEBUG_FONT, TXT_AVG,    {DEBUG_COL_AVG, DEBUG_ROW_Y(2), 30, 8}),
+    UI_LABEL(DEBUG_FONT, TXT_P99,    {DEBUG_COL_P99, DEBUG_ROW_Y(2), 30, 8}),
+    UI_LABEL(DEBUG_FONT, TXT_MAX_US, {DEBUG_COL_MAX, DEBUG_ROW_Y(2), 33, 8}),
+    UI_PERF_ROW(PERF_LOOP,     DEBUG_PERF_RECT(PERF_LOOP)),
+    UI_PERF_ROW(PERF_CAN,      DEBUG_PERF_RECT(PERF_CAN)),
+    UI_PERF_ROW(PERF_INPUT,    DEBUG_PERF_RECT(PERF_INPUT)),
+    UI_PERF_ROW(PERF_UI_BUILD, DEBUG_PERF_RECT(PERF_UI_BUILD)),
+    UI_PERF_ROW(PERF_UI_FLUSH, DEBUG_PERF_RECT(PERF_UI_FLUSH)),
+    UI_PERF_ROW(PERF_SHIFT,    DEBUG_PERF_RECT(PERF_SHIFT)),
+};
+
+// Same order as PageId
+const UiPage PAGE_LAYOUTS[PAGE_COUNT] = {
+    UI_PAGE(MAIN_PAGE),
+    UI_PAGE(SENSORS_PAGE),
+    UI_PAGE(FUEL_PAGE),
+    UI_PAGE(BOOST_PAGE),
+    UI_PAGE(CHART_PAGE),
+    UI_PAGE(STATS_PAGE),
+    UI_PAGE(DEBUG_PAGE),
+};
+
+// -------- Checks --------
+static constexpr uint8_t ui_text_len(const char *s)
+{
+  return s ? (*s ? 1 + ui_text_len(s + 1) : 0) : 0;
+}
+
+// Whatever the widget builds in draw_widget()'s buffer fits it
+static constexpr bool ui_text_fits(const UiWidget *w)
+{
+  return w->type == UI_W_LABEL
+             ? ui_text_len(w->label) < UI_WIDGET_TEXT_MAX
+             : ui_text_len(w->label) + UI_VALUE_CHARS_MAX + ui_text_len(w->unit) < UI_WIDGET_TEXT_MAX;
+}
+
+static constexpr bool ui_widgets_valid(const UiWidget *w, uint8_t n)
+{
+  return n == 0 ||
+         (w->area.rect.x >= 0 && w->area.rect.y >= 0 &&
+          w->area.rect.x + w->area.rect.w <= 128 && w->area.rect.y + w->area.rect.h <= 64 &&
+          (w->type == UI_W_LABEL || w->type == UI_W_LOGO || w->type == UI_W_CHART_PLOT || w->type == UI_W_CHART_HEADER ||
+           w->type == UI_W_READOUT || w->type == UI_W_PERF_ROW || w->sig < SIG_COUNT) &&
+          ((w->type != UI_W_BAR && w->type != UI_W_LAMBDA) || w->min < w->max) &&
+          (w->type != UI_W_READOUT || w->read != nullptr) &&
+          (w->type != UI_W_PERF_ROW || w->index < PERF_STAGE_COUNT) &&
+          (w->type != UI_W_STATS_ROW || w->sig < STATS_COUNT) &&
+          ui_text_fits(w) &&
+          ui_widgets_valid(w + 1, n - 1));
+}
+
+static constexpr uint8_t ui_widgets_of(const UiWidget *w, uint8_t n, UiWidgetType type)
+{
+  return n == 0 ? 0 : (w->type == type) + ui_widgets_of(w + 1, n - 1, type);
+}
+
+#define UI_CHECK_PAGE(table)                                                            \
+  static_assert(sizeof(table) / sizeof(table[0]) <= UI_PAGE_MAX_WIDGETS, #table ": too many widgets"); \
+  static_assert(ui_widgets_valid(table, sizeof(table) / sizeof(table[0])), #table ": widget off screen, unbound, with an empty range or too much text")
+
+UI_CHECK_PAGE(MAIN_PAGE);
+UI_CHECK_PAGE(SENSORS_PAGE);
+UI_CHECK_PAGE(FUEL_PAGE);
+UI_CHECK_PAGE(BOOST_PAGE);
+UI_CHECK_PAGE(CHART_PAGE);
+UI_CHECK_PAGE(STATS_PAGE);
+UI_CHECK_PAGE(DEBUG_PAGE);
+static_assert(ui_widgets_of(STATS_PAGE, sizeof(STATS_PAGE) / sizeof(STATS_PAGE[0]), UI_W_STATS_ROW) == STATS_COUNT,
+              "STATS_PAGE: a row per stats channel");
+static_assert(ui_widgets_of(DEBUG_PAGE, sizeof(DEBUG_PAGE) / sizeof(DEBUG_PAGE[0]), UI_W_PERF_ROW) == PERF_STAGE_COUNT,
+              "DEBUG_PAGE: a row per perf stage");
@@ -2,139 +2,94 @@
 #include "config.h"
 #include "types.h"
 #include "../common/ui_common.h"
+#include "../common/ui_text.h"
+#include "../common/ui_sprite.h"
+#include "sprites.h"
+#include "page_main.h"
 #include "prnd/prnd.h"
 #include <U8g2lib.h>
 
-
+static_assert(SPR_MODE_COUNT == MODE_MANUAL + 1, "spr_mode must have one sprite per DriveMode");
+static_assert(SPR_PRND_COUNT == PRND_D + 1, "spr_prnd must have one sprite per Prnd");
+
+// The rasterized sprites must stay inside the areas the widgets damage
+static constexpr UiRect MODE_AREA = DRIVE_MODE_RECT(0, 0);
+static constexpr UiRect PRND_AREA = PRND_RECT(0, 0);
+static constexpr UiRect GEAR_AREA = GEAR_RECT(0);
+static_assert(SPR_MODE_X >= MODE_AREA.x && SPR_MODE_X + SPR_MODE_W <= MODE_AREA.x + MODE_AREA.w &&
+                  SPR_MODE_Y >= MODE_AREA.y && SPR_MODE_Y + SPR_MODE_H <= MODE_AREA.y + MODE_AREA.h,
+              "spr_mode outside DRIVE_MODE_RECT");
+static_assert(SPR_PRND_X >= PRND_AREA.x && SPR_PRND_X + SPR_PRND_W <= PRND_AREA.x + PRND_AREA.w &&
+                  SPR_PRND_Y >= PRND_AREA.y && SPR_PRND_Y + SPR_PRND_H <= PRND_AREA.y + PRND_AREA.h,
+              "spr_prnd outside PRND_RECT");
+static_assert(53 + SPR_GEAR_X == GEAR_AREA.x && SPR_GEAR_Y == GEAR_AREA.y &&
+                  SPR_GEAR_W == GEAR_AREA.w && SPR_GEAR_H == GEAR_AREA.h,
+              "spr_gear must be the gear box");
 
 void drawDriveMode(U8G2& d, VehicleState vehicle, int boxX, int boxY, boolean isShort)
 {
   // Mode square to the right of gear (small)
   int boxSize = 15;
-  const char *ms;
-  if (isShort)
-  {
-    d.setFont(u8g2_font_t0_15b_tf);
-    ms = driveModeToShort(vehicle.driveMode);
-  }
-  else
+  if (!isShort)
   {
-    d.setFont(u8g2_font_5x7_tf);
-    ms = driveModeToText(vehicle.driveMode);
+    // Prerendered name, centered on the square
+    ui_blit(d, boxX + SPR_MODE_X, boxY + SPR_MODE_Y,
+            spr_mode[vehicle.driveMode & 3], SPR_MODE_W, SPR_MODE_H, false);
+    return;
   }
-  int msw = d.getStrWidth(ms);
+
+  const char *ms = driveModeToShort(vehicle.driveMode);
+  int msw = ui_text_width(d, DRIVE_MODE_SHORT_FONT, ms);
+  d.setFont(DRIVE_MODE_SHORT_FONT);
   d.setCursor(boxX + (boxSize - msw) / 2, boxY + 10);
   d.print(ms);
 }
 
-void drawSelectionActive(U8G2& d,int x, int y, int size)
-{
-  // y is top of triangle
-  d.drawTriangle(
-      x + size / 2, y,
-      x + size / 2, y + size,
-      x, y + size / 2);
-
-  int offset = size / 2 + 2;
-
-  d.drawTriangle(
-      x + offset, y,
-      x + offset, y + size,
-      x + size / 2 + offset, y + size / 2);
-}
-
 void drawPRND(U8G2& d, Prnd prnd, int x, int y, boolean selectWindowActive)
 {
   if (selectWindowActive)
   {
-    drawSelectionActive(d, x + 16, y - 7, 6);
+    ui_blit(d, x + 16, y - 7, spr_arrows[SPR_ARROWS_SELECT], SPR_ARROWS_W, SPR_ARROWS_H, false);
   }
 
-  d.drawBox(x + 16, y, 9, 13);
-  d.setDrawColor(0);
-  d.setCursor(x + 16, y + 12);
-  d.setFont(u8g2_font_t0_18b_tr);
-  d.print(prndToStr(prnd));
-  d.setDrawColor(1);
-
-  switch (prnd)
-  {
-  case PRND_P:
-    d.setFont(u8g2_font_5x7_tf);
-    d.setCursor(x + 26, y + 10);
-    d.print("RND");
-    break;
-
-  case PRND_R:
-    d.setCursor(x + 11, y + 10);
-    d.setFont(u8g2_font_5x7_tf);
-    d.print("P");
-    d.setCursor(x + 26, y + 10);
-    d.setFont(u8g2_font_5x7_tf);
-    d.print("ND");
-    break;
-
-  case PRND_N:
-    d.setFont(u8g2_font_5x7_tf);
-    d.print("PR");
-    d.setCursor(x + 26, y + 10);
-    d.setFont(u8g2_font_5x7_tf);
-    d.print("D");
-    break;
-
-  case PRND_D:
-    d.setFont(u8g2_font_5x7_tf);
-    d.setCursor(x + 1, y + 10);
-    d.print("PRN");
-    break;
-
-  default:
-    break;
-  }
+  // Whole strip, current letter boxed
+  ui_blit(d, x + SPR_PRND_X, y + SPR_PRND_Y, spr_prnd[prnd & 3], SPR_PRND_W, SPR_PRND_H, false);
 }
 
 void drawActualGear(U8G2& d, int gear, int y)
 {
-  d.drawRBox(53, y, 22, 23, 3);
-  d.setFont(u8g2_font_luBS19_te);
-  const char *g = gearToStr(gear);
-
-  // Measure text width to truly center
-  int gw = d.getStrWidth(g);
-  int gx = (128 - gw) / 2;
-  int gy = y + 21; // baseline near top row
-  d.setDrawColor(0);
-  d.setFontMode(1);
-  d.setCursor(gx, gy);
-  d.print(g);
-  d.setDrawColor(1);
+  // Prerendered box per gear: R, N, 1..9
+  if (gear < -1 || gear > 9)
+  {
+    d.drawRBox(53, y, 22, 23, 3);
+    return;
+  }
+  uint8_t i = gear < 0 ? SPR_GEAR_R : gear == 0 ? SPR_GEAR_N : SPR_GEAR_1 + gear - 1;
+  ui_blit(d, 53 + SPR_GEAR_X, y + SPR_GEAR_Y, spr_gear[i], SPR_GEAR_W, SPR_GEAR_H, true);
 }
 
 void drawOdometerCentered(U8G2& d, uint32_t odometer_km, int baselineY)
 {
   char num[12];
-  snprintf(num, sizeof(num), "%lu", (unsigned long)odometer_km);
+  formatInt(num, odometer_km);
 
   const char *unit = "km";
   const int gap = 3;
 
   // Measure widths in their respective fonts
-  d.setFont(u8g2_font_6x13B_mf);
-  int wNum = d.getStrWidth(num);
-
-  d.setFont(u8g2_font_6x10_tf);
-  int wUnit = d.getStrWidth(unit);
+  int wNum = ui_text_width(d, ODOMETER_FONT, num);
+  int wUnit = ui_text_width(d, ODOMETER_UNIT_FONT, unit);
 
   int totalW = wNum + gap + wUnit;
   int x = (128 - totalW) / 2;
 
   // Draw number
-  d.setFont(u8g2_font_6x13B_mf);
+  d.setFont(ODOMETER_FONT);
   d.setCursor(x, baselineY);
   d.print(num);
 
   // Draw unit
-  d.setFont(u8g2_font_5x8_mf);
+  d.setFont(ODOMETER_UNIT_FONT);
   d.setCursor(x + wNum + gap, baselineY);
   d.print(unit);
 }
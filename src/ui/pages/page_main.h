@@ -1,9 +1,27 @@
 // src/ui/ui.h
 #pragma once
 #include "types.h"
+#include "../common/ui_common.h"
+
+// What each widget reads (see DIRTY_* in ui_common.h)
+#define DRIVE_MODE_DEPS SIG_BIT(SIG_DRIVE_MODE)
+#define PRND_DEPS (SIG_BIT(SIG_PRND) | DIRTY_SELECT_WINDOW)
+#define GEAR_DEPS SIG_BIT(SIG_GEAR)
+#define ODOMETER_DEPS SIG_BIT(SIG_ODO)
+#define TRIP_DEPS SIG_BIT(SIG_TRIP)
+
+// Area each widget draws into, from the same arguments as its draw call
+#define DRIVE_MODE_RECT(boxX, boxY) {(boxX) - 12, (boxY) - 2, 40, 16}
+#define PRND_RECT(x, y) {(x), (y) - 7, 48, 21}
+#define GEAR_RECT(y) {53, (y), 22, 23}
+#define ODOMETER_RECT(baselineY) {0, (baselineY) - 12, 128, 15}
+
+// Fonts, shared with the text metrics prewarm in ui_init()
+#define DRIVE_MODE_SHORT_FONT u8g2_font_t0_15b_tf
+#define ODOMETER_FONT u8g2_font_6x13B_mf
+#define ODOMETER_UNIT_FONT u8g2_font_5x8_mf
 
 void drawDriveMode(U8G2& d, VehicleState vehicle, int boxX, int boxY, boolean isShort);
-void drawSelectionActive(U8G2& d,int x, int y, int size);
 void drawPRND(U8G2& d, Prnd prnd, int x, int y, boolean selectWindowActive);
 void drawActualGear(U8G2& d, int gear, int y);
 void drawOdometerCentered(U8G2& d, uint32_t odometer_km, int baselineY);
@@ -0,0 +1,35 @@
+#include "types.h"
+#include "stats/stats.h"
+#include "../common/ui_common.h"
+#include "../common/ui_layout.h"
+#include "page_stats.h"
+#include <U8g2lib.h>
+
+static void print_signal(U8G2& d, int x, int y, SignalId sig, int32_t v)
+{
+  char num[12];
+  formatSignal(num, sig, v);
+  d.drawStr(x, y, num);
+}
+
+void drawStatsRow(U8G2& d, const UiRect &r, SignalId sig)
+{
+  const StatsChannelInfo &info = stats_info(sig);
+  const SignalStats &s = stats_get(sig);
+  int y = UI_ROW_BASELINE(r);
+
+  d.setFont(STATS_FONT);
+  d.drawStr(r.x, y, info.name);
+  if (!s.valid)
+  {
+    d.drawStr(r.x + STATS_COL_MIN, y, "-");
+    return;
+  }
+  print_signal(d, r.x + STATS_COL_MIN, y, sig, s.min);
+  print_signal(d, r.x + STATS_COL_MAX, y, sig, s.max);
+  print_signal(d, r.x + STATS_COL_AVG, y, sig, stats_mean(sig));
+
+  char num[12];
+  strcpy(formatInt(num, s.overMs / 1000), "s");
+  d.drawStr(r.x + STATS_COL_PAST, y, num);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "types.h"
+#include "../common/ui_common.h"
+
+class U8G2;
+
+#define STATS_FONT u8g2_font_5x7_tf
+// Column headers are labels in the page table; rows go below them
+#define STATS_COL_MIN 24
+#define STATS_COL_MAX 50
+#define STATS_COL_AVG 76
+#define STATS_COL_PAST 102
+#define STATS_HEADER_H 9
+#define STATS_ROW_RECT(sig) {0, STATS_HEADER_H + 8 * (sig), 128, 7}
+
+// A stats channel's row: min, max, mean and time past its threshold, since
+// power-on or the last reset (mode button on this page)
+void drawStatsRow(U8G2& d, const UiRect &r, SignalId sig);
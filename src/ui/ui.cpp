@@ -7,66 +7,142 @@
 #include "pins.h"
 #include "amg_logo.h"
 #include "common/ui_common.h"
+#include "common/ui_damage.h"
+#include "common/ui_layout.h"
+#include "common/ui_text.h"
+#include "common/ui_sprite.h"
 #include "prnd/prnd.h"
-
+#include "vehicle/vehicle.h"
+#include "can/canbus.h"
+#include "diag/perf.h"
+#include "history/history.h"
+#include "stats/stats.h"
+#include "alarm/alarm.h"
+#include "vehicle/stale.h"
+
+#ifdef NATIVE
+#include <native_display.h>
+static NativeSsd1306 u8g2(
+#elif UI_BUFFER_MODE == UI_BUFFER_PAGE1
+static U8G2_SSD1306_128X64_NONAME_1_4W_HW_SPI u8g2(
+#elif UI_BUFFER_MODE == UI_BUFFER_PAGE2
+static U8G2_SSD1306_128X64_NONAME_2_4W_HW_SPI u8g2(
+#else
 static U8G2_SSD1306_128X64_NONAME_F_4W_HW_SPI u8g2(
+#endif
   U8G2_R0,
   OLED_CS,
   OLED_DC,
   OLED_RST
 );
 
+// Fonts with centered text (see ui_text.h)
+#define BODY_FONT u8g2_font_6x10_tf
+#define ANNOUNCE_FONT u8g2_font_helvB14_tf
+#define ALARM_FONT u8g2_font_6x13B_tf
+
+// Alarm overlay: only the value line changes while it is up
+#define ALARM_VALUE_RECT {0, 45, 128, 16}
+
 uint8_t currentPage = PAGE_MAIN;
 
 uint32_t modeAnnounceStartMs = 0;
 uint32_t bootMs = 0;
 UiMode uiMode = UI_SPLASH;
+static uint8_t shownAlarm = ALARM_NONE;
+
+extern volatile uint32_t lastCanMs;
+
+// -------- Dirty tracking --------
+// What was on screen last frame; compared against live state each tick.
+static UiFrameState drawn;
+static bool uiForceRedraw = true;
+// Full buffer only: the buffer still holds the page as drawn, so the next
+// frame redraws just the widgets in pendingWidgets
+static bool pageInBuffer = false;
+static UiWidgetSet pendingWidgets = 0;
+
+// -------- Strip chart --------
+static HistChannel chartChannel = HIST_LAMBDA;
+// Samples the plot in the buffer was drawn up to, so the next frame can
+// scroll it
+static uint16_t chartBufferEnd = 0;
 
 void ui_init() {
   u8g2.begin();
   u8g2.setContrast(120);
-}
-
-void cycleDriveMode(VehicleState& vehicle)
-{
-  vehicle.driveMode = (DriveMode)((vehicle.driveMode + 1) % 4);
-  uiMode = UI_MODE_ANNOUNCE;
-  modeAnnounceStartMs = millis();
-}
 
+  // Text metrics for everything centered per frame
+  ui_text_number_font(u8g2, ODOMETER_FONT);
+  ui_text_number_font(u8g2, BODY_FONT);
 
-void draw_main_page(VehicleState& vehicle)
-{
-  u8g2.clearBuffer();
+  static const char *const UNIT_LABELS[] = {"km"};
+  ui_text_prewarm(u8g2, ODOMETER_UNIT_FONT, UNIT_LABELS, 1);
+  for (uint8_t m = MODE_COMFORT; m <= MODE_MANUAL; m++)
+  {
+    ui_text_width(u8g2, DRIVE_MODE_SHORT_FONT, driveModeToShort((DriveMode)m));
+    ui_text_width(u8g2, ANNOUNCE_FONT, driveModeToText((DriveMode)m));
+  }
 
-  // AMG logo
-  u8g2.drawXBMP(77, 56, AMG_SMALL_W, AMG_SMALL_H, amg_bits_small);
+  ui_text_number_font(u8g2, ALARM_FONT);
+  ui_text_width(u8g2, BODY_FONT, "ALARM");
+  ui_text_width(u8g2, ANNOUNCE_FONT, "NO CAN");
+  ui_text_width(u8g2, BODY_FONT, "no frames from ECU");
+  for (uint8_t i = 0; i < alarm_count(); i++)
+    ui_text_width(u8g2, ALARM_FONT, alarm_text(i));
 
-  drawOdometerCentered(u8g2, vehicle.odo, 18);
-  drawOdometerCentered(u8g2,839, 30);
+  ui_layout_prewarm(u8g2);
+}
 
-  drawDriveMode(u8g2, vehicle, 96, 44, false);
-  drawPRND(u8g2, vehicle.prnd, 5, 48, getSelectWindowActive());
-  drawActualGear(u8g2,vehicle.gear, 41);
+U8G2 &ui_display()
+{
+  return u8g2;
+}
 
-  switch (currentPage)
+void mode_button(VehicleState& vehicle)
+{
+  // Acknowledges an alarm first of all
+  if (uiMode == UI_MODE_ALARM)
   {
-  case PAGE_MAIN:
-    break;
+    alarm_ack(shownAlarm);
+    return;
+  }
+  // The chart page uses it to pick what to plot
+  if (uiMode == UI_PAGES && currentPage == PAGE_CHART)
+  {
+    chartChannel = (HistChannel)((chartChannel + 1) % HIST_COUNT);
+    uiForceRedraw = true;
+    return;
+  }
+  // ... and the stats page to start a new session
+  if (uiMode == UI_PAGES && currentPage == PAGE_STATS)
+  {
+    stats_reset();
+    uiForceRedraw = true;
+    return;
   }
+  cycleDriveMode(vehicle);
+}
 
-  u8g2.sendBuffer();
+void cycleDriveMode(VehicleState& vehicle)
+{
+  vehicle.driveMode = (DriveMode)((vehicle.driveMode + 1) % 4);
+  uiMode = UI_MODE_ANNOUNCE;
+  modeAnnounceStartMs = millis();
+  uiForceRedraw = true;
 }
 
 
 // ----------------- Helpers -----------------
 void draw_splash()
 {
-  u8g2.clearBuffer();
   int x = (128 - AMG_W) / 2;
   int y = (64 - AMG_H) / 2;
-  u8g2.drawXBMP(x, y, AMG_W, AMG_H, amg_bits);
-  u8g2.sendBuffer();
+  u8g2.firstPage();
+  do
+  {
+    u8g2.drawXBMP(x, y, AMG_W, AMG_H, amg_bits);
+  } while (u8g2.nextPage());
 }
 
 // ----------------- Page drawing -----------------
@@ -121,9 +197,9 @@ void drawProgressBarWithInvertedText(
     u8g2.drawBox(x + 1, y + 1, fillW, innerH);
   }
 
-  u8g2.setFont(u8g2_font_6x10_tf);
+  u8g2.setFont(BODY_FONT);
   // Center text
-  int tw = u8g2.getStrWidth(text);
+  int tw = ui_text_width(u8g2, BODY_FONT, text);
   int ascent = u8g2.getAscent();
   int descent = u8g2.getDescent(); // usually <= 0
   int th = ascent - descent;
@@ -143,7 +219,7 @@ void drawProgressBarWithInvertedText(
     u8g2.setDrawColor(0);
     u8g2.setCursor(tx, ty);
     u8g2.print(text);
-    u8g2.setMaxClipWindow(); // reset clipping
+    u8g2.setClipWindow(x, y, x + w, y + h); // back to the bar's own area
   }
 
   u8g2.setDrawColor(1); // restore default
@@ -152,10 +228,11 @@ void drawProgressBarWithInvertedText(
   u8g2.drawRFrame(x, y, w, h, 3);
 }
 
+// lambda and range in 1/1000
 void drawLambdaLine(
     int x, int y, int w, int h,
-    float lambda,
-    float minL, float maxL)
+    int16_t lambda,
+    int16_t minL, int16_t maxL)
 {
   // Frame
   u8g2.drawFrame(x, y, w, h);
@@ -171,12 +248,12 @@ void drawLambdaLine(
   int innerH = h - 2;
 
   // Position of lambda line
-  int lineX = x + 1 + (int)((lambda - minL) * innerW / (maxL - minL));
+  int lineX = x + 1 + (int32_t)(lambda - minL) * innerW / (maxL - minL);
 
   // Draw center reference line (optional, stoich = 1.00)
-  if (minL < 1.0f && maxL > 1.0f)
+  if (minL < 1000 && maxL > 1000)
   {
-    int stoichX = x + 1 + (int)((1.0f - minL) * innerW / (maxL - minL));
+    int stoichX = x + 1 + (int32_t)(1000 - minL) * innerW / (maxL - minL);
     u8g2.drawVLine(stoichX, y + 1, innerH);
   }
 
@@ -185,139 +262,307 @@ void drawLambdaLine(
   u8g2.drawVLine(lineX + 1, y + 1, innerH); // thickness = 2px
 }
 
-void draw_sensors_page(VehicleState vehicle)
+void draw_mode_announcement(const VehicleState& vehicle)
 {
-  u8g2.clearBuffer();
-  u8g2.setFont(u8g2_font_6x10_tf);
-  u8g2.drawStr(0, 10, "Sensors");
+  // AMG logo
+  int logoX = (128 - AMG_W) / 2;
+  int logoY = 10;
+  u8g2.drawXBMP(logoX, logoY, AMG_W, AMG_H, amg_bits);
 
-  char mapTxt[20];
-  snprintf(mapTxt, sizeof(mapTxt), "MAP %d kpa", vehicle.map_kpa);
-  drawProgressBarWithInvertedText(0, 39, 128, 11, vehicle.map_kpa, 0, 250, mapTxt);
+  // Drive mode text (wide + bold)
+  u8g2.setFont(ANNOUNCE_FONT);
+  const char *txt = driveModeToText(vehicle.driveMode);
 
-  char rpmTxt[20];
-  snprintf(rpmTxt, sizeof(rpmTxt), "RPM %d", vehicle.rpm);
-  drawProgressBarWithInvertedText(0, 52, 128, 11, vehicle.rpm, 0, 9000, rpmTxt);
+  int tw = ui_text_width(u8g2, ANNOUNCE_FONT, txt);
+  int tx = (128 - tw) / 2;
+  int ty = logoY + AMG_H + 16;
+
+  u8g2.setCursor(tx, ty);
+  u8g2.print(txt);
+}
+
+void draw_alarm(const VehicleState& vehicle)
+{
+  // Inverted title bar
+  u8g2.drawBox(0, 0, 128, 16);
+  u8g2.setDrawColor(0);
+  u8g2.setFont(BODY_FONT);
+  u8g2.drawStr((128 - ui_text_width(u8g2, BODY_FONT, "ALARM")) / 2, 12, "ALARM");
+  u8g2.setDrawColor(1);
 
-  drawLambdaLine(0, 15, 128, 11, 0.94, 0.70, 1.24);
+  const char *txt = alarm_text(shownAlarm);
+  u8g2.setFont(ALARM_FONT);
+  u8g2.drawStr((128 - ui_text_width(u8g2, ALARM_FONT, txt)) / 2, 34, txt);
 
-  u8g2.sendBuffer();
+  char num[12];
+  SignalId sig = alarm_signal(shownAlarm);
+  formatSignal(num, sig, vehicle_get(vehicle, sig));
+  u8g2.drawStr((128 - ui_text_width(u8g2, ALARM_FONT, num)) / 2, 56, num);
 }
 
-void draw_fuel_page(VehicleState vehicle)
+void draw_no_can()
 {
-  u8g2.clearBuffer();
-  u8g2.setFont(u8g2_font_6x10_tf);
-  u8g2.drawStr(0, 10, "Fuel / Lambda");
-
-  u8g2.setCursor(0, 28);
-  u8g2.print("Lambda: ");
-  u8g2.print(vehicle.lambda, 2);
-  u8g2.setCursor(0, 44);
-  u8g2.print("OilP: ");
-  u8g2.print(vehicle.oilp, 1);
-
-  u8g2.sendBuffer();
+  u8g2.setFont(ANNOUNCE_FONT);
+  u8g2.drawStr((128 - ui_text_width(u8g2, ANNOUNCE_FONT, "NO CAN")) / 2, 32, "NO CAN");
+  u8g2.setFont(BODY_FONT);
+  u8g2.drawStr((128 - ui_text_width(u8g2, BODY_FONT, "no frames from ECU")) / 2, 50, "no frames from ECU");
 }
 
-void draw_debug_page()
+// Take the state the next frame shows; every band of it draws from this
+static void frame_begin(const VehicleState& vehicle)
 {
-  u8g2.clearBuffer();
-  u8g2.setFont(u8g2_font_6x10_tf);
-  u8g2.drawStr(0, 10, "Debug");
+  if (uiForceRedraw)
+  {
+    ui_damage_all();
+    pageInBuffer = false;
+  }
+  drawn.vehicle = vehicle;
+  drawn.selectWindow = getSelectWindowActive();
+  drawn.history.end = history_seq();
+  drawn.history.count = history_count();
+  drawn.stale = stale_mask();
+  drawn.chartChannel = chartChannel;
+  drawn.chartScroll = drawn.history.end - chartBufferEnd;
+  drawn.page = currentPage < PAGE_COUNT ? currentPage : (uint8_t)PAGE_MAIN;
+  uiForceRedraw = false;
+}
 
-  u8g2.setCursor(0, 24);
-  u8g2.print("Page: ");
-  u8g2.print(currentPage);
-  u8g2.setCursor(0, 36);
-  u8g2.print("CAN age: ");
+// Draw one of the full screen states; false if it's the pages
+static bool draw_overlay()
+{
+  switch (uiMode)
+  {
+  case UI_MODE_ANNOUNCE:
+    draw_mode_announcement(drawn.vehicle);
+    return true;
+  case UI_MODE_ALARM:
+    draw_alarm(drawn.vehicle);
+    return true;
+  case UI_NO_CAN:
+    draw_no_can();
+    return true;
+  default:
+    return false;
+  }
+}
 
-  u8g2.sendBuffer();
+// Draw the frame into the buffer (the current band in page-buffer mode)
+static void draw_frame()
+{
+  bool pages = uiMode == UI_PAGES || uiMode == UI_SPLASH;
+  const UiPage &layout = PAGE_LAYOUTS[drawn.page];
+  if (pages && pageInBuffer)
+  {
+    ui_layout_update(u8g2, layout, drawn, pendingWidgets);
+  }
+  else
+  {
+    u8g2.clearBuffer();
+    if (draw_overlay())
+      return;
+    ui_layout_draw(u8g2, layout, drawn);
+  }
+  pendingWidgets = 0;
+#if UI_BUFFER_MODE == UI_BUFFER_FULL
+  pageInBuffer = true;
+  chartBufferEnd = drawn.history.end;
+#endif
 }
 
+// Damage the areas whose inputs changed since the page was drawn.
+// Returns true if anything needs to go out.
+static bool page_damage(const VehicleState& vehicle, bool clockTick)
+{
+  if (uiForceRedraw)
+    return true;
+
+  SignalMask changed = vehicle_diff(vehicle, drawn.vehicle);
+  if (getSelectWindowActive() != drawn.selectWindow)
+    changed |= DIRTY_SELECT_WINDOW;
+  if (clockTick)
+    changed |= DIRTY_CLOCK;
+  changed |= stale_mask() ^ drawn.stale; // greyed out or back
+  if (history_seq() != drawn.history.end)
+    changed |= DIRTY_HISTORY;
+
+  uint8_t page = currentPage < PAGE_COUNT ? currentPage : (uint8_t)PAGE_MAIN;
+  pendingWidgets |= ui_layout_damage(PAGE_LAYOUTS[page], changed);
+  return ui_damage_pending();
+}
+
+// Build the whole frame without sending it (every band in page-buffer mode)
 void draw_current_page(VehicleState& vehicle)
 {
-  switch (currentPage)
+  page_damage(vehicle, true);
+  frame_begin(vehicle);
+#if UI_BUFFER_MODE == UI_BUFFER_FULL
+  draw_frame();
+#else
+  for (uint8_t row = 0; row < UI_TILE_ROWS; row += u8g2.getBufferTileHeight())
   {
-  case PAGE_MAIN:
-    draw_main_page(vehicle);
-    break;
-  case PAGE_SENSORS:
-    draw_sensors_page(vehicle);
-    break;
-  case PAGE_FUEL:
-    draw_fuel_page(vehicle);
-    break;
-  case PAGE_DEBUG:
-    draw_debug_page();
-    break;
-  default:
-    draw_main_page(vehicle);
-    break;
+    u8g2.setBufferCurrTileRow(row);
+    draw_frame();
   }
+#endif
 }
 
 // ----------------- Page navigation -----------------
 void next_page()
 {
-  currentPage = (currentPage + 1) % PAGE_COUNT;
+  ui_show_page((PageId)((currentPage + 1) % PAGE_COUNT));
 }
 
-void draw_mode_announcement(const VehicleState& vehicle)
+void ui_show_page(PageId page)
 {
-  u8g2.clearBuffer();
+  currentPage = page;
+  uiForceRedraw = true;
+}
 
-  // AMG logo
-  int logoX = (128 - AMG_W) / 2;
-  int logoY = 10;
-  u8g2.drawXBMP(logoX, logoY, AMG_W, AMG_H, amg_bits);
+// -------- Frame output --------
+// Full buffer: the frame is built once, then sent in slices.
+// Page buffer: each slice draws and sends bands until the budget runs out;
+// bands without damage are skipped.
 
-  // Drive mode text (wide + bold)
-  u8g2.setFont(u8g2_font_helvB14_tf);
-  const char *txt = driveModeToText(vehicle.driveMode);
+#if UI_BUFFER_MODE == UI_BUFFER_FULL
+static bool frame_start()
+{
+  PERF_SCOPE(PERF_UI_BUILD);
+  draw_frame();
+  return true;
+}
 
-  int tw = u8g2.getStrWidth(txt);
-  int tx = (128 - tw) / 2;
-  int ty = logoY + AMG_H + 16;
+static bool frame_continue()
+{
+  return ui_damage_flush(u8g2, UI_TASK_BUDGET_US);
+}
+#else
+static uint8_t nextBand = 0;
 
-  u8g2.setCursor(tx, ty);
-  u8g2.print(txt);
+static bool frame_start()
+{
+  nextBand = 0;
+  return true;
+}
 
-  u8g2.sendBuffer();
+static bool frame_continue()
+{
+  uint32_t startUs = micros();
+  uint8_t rows = u8g2.getBufferTileHeight();
+  for (; nextBand < UI_TILE_ROWS; nextBand += rows)
+  {
+    if (!ui_damage_band_pending(nextBand, rows))
+      continue;
+    if (micros() - startUs >= UI_TASK_BUDGET_US)
+      return true; // resume from this band next slice
+
+    u8g2.setBufferCurrTileRow(nextBand);
+    {
+      PERF_SCOPE(PERF_UI_BUILD);
+      draw_frame();
+    }
+    ui_damage_flush_band(u8g2);
+  }
+  ui_damage_end_frame();
+  return false;
 }
+#endif
 
-void draw_ui(VehicleState& vehicle)
+// Runs as a scheduler task, one slice per call: either build a frame or
+// send part of it. Returns true while a frame is still going out.
+bool draw_ui(VehicleState& vehicle)
 {
-    // Throttle UI redraw (e.g. 10 fps)
-  static uint32_t lastUiMs = 0;
+  static uint32_t lastClockMs = 0;
+  static bool flushing = false;
+
+  if (flushing)
+  {
+    PERF_SCOPE(PERF_UI_FLUSH);
+    flushing = frame_continue();
+    if (!flushing)
+      perf_note_frame();
+    return flushing;
+  }
+
   uint32_t now = millis();
-  if (now - lastUiMs < UI_PERIOD_MS)
-    return;
-  lastUiMs = now;
 
   // State machine
   if (uiMode == UI_SPLASH)
   {
-    if (now - bootMs >= SPLASH_MS)
+    if (now - bootMs < SPLASH_MS)
+      return false; // don't redraw splash continuously (drawn once in setup)
+    uiMode = UI_PAGES;
+    currentPage = PAGE_MAIN;
+    uiForceRedraw = true;
+  }
+
+  // Nothing on screen can be trusted once the bus goes quiet
+  bool quiet = now - lastCanMs >= CAN_QUIET_MS;
+  if (quiet != (uiMode == UI_NO_CAN))
+  {
+    uiMode = quiet ? UI_NO_CAN : UI_PAGES;
+    shownAlarm = ALARM_NONE; // shown again below if still raised
+    uiForceRedraw = true;
+  }
+  if (uiMode == UI_NO_CAN)
+  {
+    // Static screen: draw once on entry
+    if (!uiForceRedraw)
+      return false;
+    frame_begin(vehicle);
+    flushing = frame_start();
+    return true;
+  }
+
+  // Alarms preempt pages and the mode announcement; back to the pages when
+  // none is left to show
+  uint8_t alarm = alarm_top();
+  if (alarm != shownAlarm)
+  {
+    shownAlarm = alarm;
+    uiMode = alarm != ALARM_NONE ? UI_MODE_ALARM : UI_PAGES;
+    uiForceRedraw = true;
+  }
+
+  if (uiMode == UI_MODE_ALARM)
+  {
+    SignalId sig = alarm_signal(shownAlarm);
+    if (!uiForceRedraw)
     {
-      uiMode = UI_PAGES;
-      currentPage = PAGE_MAIN;
-      draw_current_page(vehicle);
+      if (vehicle_get(vehicle, sig) == vehicle_get(drawn.vehicle, sig))
+        return false;
+      ui_damage_rect(ALARM_VALUE_RECT);
     }
-    return; // don't redraw splash continuously (assuming drawn once in setup)
+    frame_begin(vehicle);
+    flushing = frame_start();
+    return true;
   }
 
   if (uiMode == UI_MODE_ANNOUNCE)
   {
-    draw_mode_announcement(vehicle);
     if (now - modeAnnounceStartMs >= MODE_ANNOUNCE_MS)
     {
       uiMode = UI_PAGES;
-      draw_current_page(vehicle);
+      uiForceRedraw = true;
+    }
+    else
+    {
+      // Static screen: draw once on entry
+      if (!uiForceRedraw)
+        return false;
+      frame_begin(vehicle);
+      flushing = frame_start();
+      return true;
     }
-    return;
   }
 
-  // Normal pages mode
-  draw_current_page(vehicle);
-}
\ No newline at end of file
+  // Normal pages mode: time-based content every UI_PERIOD_MS
+  bool clockTick = now - lastClockMs >= UI_PERIOD_MS;
+  if (!page_damage(vehicle, clockTick))
+    return false;
+
+  if (clockTick)
+    lastClockMs = now;
+  frame_begin(vehicle);
+  flushing = frame_start();
+  return true;
+}
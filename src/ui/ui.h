@@ -1,9 +1,19 @@
 #pragma once
 #include "types.h"
 
+class U8G2;
+
 void ui_init();
-void draw_main_page(VehicleState &vehicle);
 void draw_splash();
 void cycleDriveMode(VehicleState &vehicle);
-void draw_ui(VehicleState &vehicle);
+void mode_button(VehicleState &vehicle);
+bool draw_ui(VehicleState &vehicle);
 void next_page();
+void ui_show_page(PageId page);
+
+// Drawing entry points, exposed for the benchmarks
+U8G2 &ui_display();
+void draw_current_page(VehicleState &vehicle);
+// Leaves the clip window on the bar
+void drawProgressBarWithInvertedText(int x, int y, int w, int h, int value, int minV, int maxV, const char *text);
+void drawLambdaLine(int x, int y, int w, int h, int16_t lambda, int16_t minL, int16_t maxL);
@@ -0,0 +1,85 @@
+#include "odometer.h"
+#include "config.h"
+
+// 1/10 km/h -> 2^-16 m/ms: 65536 / 36000 = 1.8204 ~ 466 / 256 (-0.006%)
+#define SPEED_TO_Q16_MUL 466
+#define SPEED_TO_Q16_SHIFT 8
+#define SPEED_MAX 35000 // 3500 km/h keeps the Q16 speed in 16 bits
+
+static_assert(ODO_MAX_DT_MS <= 255, "dt is multiplied as 8 bits");
+
+static uint16_t lastMs = 0;
+static bool started = false;
+static uint16_t speedQ16 = 0; // previous frame's speed, 2^-16 m/ms
+static uint32_t accQ16 = 0;   // distance not yet carried, 2^-16 m
+static uint16_t odoFracM = 0;
+static uint16_t tripFracM = 0;
+
+// Carry whole km; runs once per km, so no division on the frame path
+static SignalMask add_metres(VehicleState &vehicle, uint16_t m)
+{
+  SignalMask changed = 0;
+  odoFracM += m;
+  while (odoFracM >= 1000)
+  {
+    odoFracM -= 1000;
+    vehicle.odo++;
+    changed |= SIG_BIT(SIG_ODO);
+  }
+  tripFracM += m;
+  while (tripFracM >= 1000)
+  {
+    tripFracM -= 1000;
+    vehicle.trip++;
+    changed |= SIG_BIT(SIG_TRIP);
+  }
+  return changed;
+}
+
+SignalMask odometer_sample(VehicleState &vehicle, int32_t speed, uint16_t tMs)
+{
+  uint16_t dt = tMs - lastMs;
+  lastMs = tMs;
+  if (!started)
+  {
+    started = true;
+    dt = 0;
+  }
+  else if (dt > ODO_MAX_DT_MS)
+  {
+    dt = ODO_MAX_DT_MS;
+  }
+
+  // Distance at the speed that held over dt, then take the new one
+  accQ16 += (uint32_t)speedQ16 * (uint8_t)dt;
+  uint16_t v = speed < 0 ? 0 : speed > SPEED_MAX ? SPEED_MAX : speed;
+  speedQ16 = ((uint32_t)v * SPEED_TO_Q16_MUL) >> SPEED_TO_Q16_SHIFT;
+
+  uint16_t m = accQ16 >> 16;
+  if (!m)
+    return 0;
+  accQ16 &= 0xFFFF;
+  return add_metres(vehicle, m);
+}
+
+void odometer_reset_trip(VehicleState &vehicle)
+{
+  vehicle.trip = 0;
+  tripFracM = 0;
+}
+
+uint16_t odometer_odo_frac_m()
+{
+  return odoFracM;
+}
+
+uint16_t odometer_trip_frac_m()
+{
+  return tripFracM;
+}
+
+void odometer_restore(uint16_t odo, uint16_t trip)
+{
+  odoFracM = odo < 1000 ? odo : 0;
+  tripFracM = trip < 1000 ? trip : 0;
+}
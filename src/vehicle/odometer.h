@@ -0,0 +1,22 @@
+#pragma once
+#include "types.h"
+
+// -------- Distance integration --------
+// Every speed frame adds the distance covered at the previous speed since
+// the previous frame, timed by the frames' receive stamps. Integer only:
+// speed is turned into 2^-16 m per ms once per frame, the product with dt
+// goes into a 16.16 metre accumulator and whole metres carry into the km
+// counters. dt is clamped to ODO_MAX_DT_MS, so a CAN outage adds at most
+// that much travel at the last speed; frames drained in one burst share a
+// stamp and add nothing until the next one.
+
+// Speed frame decoded (1/10 km/h). Returns SIG_ODO / SIG_TRIP if a km
+// rolled over.
+SignalMask odometer_sample(VehicleState &vehicle, int32_t speed, uint16_t tMs);
+
+void odometer_reset_trip(VehicleState &vehicle);
+
+// Metres into the current km, for persist
+uint16_t odometer_odo_frac_m();
+uint16_t odometer_trip_frac_m();
+void odometer_restore(uint16_t odoFracM, uint16_t tripFracM);
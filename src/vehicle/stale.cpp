@@ -0,0 +1,64 @@
+#include "stale.h"
+#include "config.h"
+
+#define TICKS(ms) ((ms) / STALE_TICK_MS)
+
+// Indexed by SignalId, in ticks; 0 = not watched
+static const uint16_t TIMEOUTS[SIG_COUNT] = {
+    TICKS(STALE_FAST_MS), // RPM
+    TICKS(STALE_FAST_MS), // MAP
+    TICKS(STALE_FAST_MS), // LAMBDA
+    TICKS(STALE_FAST_MS), // TPS
+    TICKS(STALE_SLOW_MS), // CLT
+    TICKS(STALE_SLOW_MS), // IAT
+    TICKS(STALE_SLOW_MS), // OILP
+    TICKS(STALE_FAST_MS), // SPEED
+    0,                    // ODO
+    0,                    // TRIP
+    TICKS(STALE_FAST_MS), // GEAR
+    0,                    // PRND
+    0,                    // DRIVE_MODE
+};
+static_assert(SIG_COUNT == 13, "TIMEOUTS is indexed by SignalId");
+
+static uint16_t nowTick = 0;
+static uint16_t seenTick[SIG_COUNT];
+static SignalMask stale = 0;
+static uint8_t nextCheck = 0;
+
+void stale_set_clock(uint32_t nowMs)
+{
+  nowTick = nowMs / STALE_TICK_MS;
+}
+
+void stale_note(SignalId sig)
+{
+  seenTick[sig] = nowTick;
+}
+
+void stale_check(uint32_t nowMs)
+{
+  uint16_t tick = nowMs / STALE_TICK_MS;
+  for (uint8_t n = 0; n < STALE_CHECKS_PER_CALL; n++)
+  {
+    uint8_t s = nextCheck;
+    nextCheck = nextCheck + 1 < SIG_COUNT ? nextCheck + 1 : 0;
+
+    uint16_t timeout = TIMEOUTS[s];
+    if (!timeout)
+      continue;
+    if ((uint16_t)(tick - seenTick[s]) <= timeout)
+    {
+      stale &= ~SIG_BIT(s);
+      continue;
+    }
+    stale |= SIG_BIT(s);
+    // Keep the age just past the timeout, so it can't wrap back to fresh
+    seenTick[s] = tick - timeout - 1;
+  }
+}
+
+SignalMask stale_mask()
+{
+  return stale;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "types.h"
+
+// -------- Stale signal watchdog --------
+// Last update time per signal as a 16-bit tick (STALE_TICK_MS each). The
+// decoder only stores the tick; stale_check() compares a few signals per
+// call against their timeouts, so a full sweep is spread over several
+// calls. Signals without a timeout (not from CAN) are never stale.
+
+void stale_set_clock(uint32_t nowMs); // once per decode batch
+void stale_note(SignalId sig);        // signal decoded, changed or not
+void stale_check(uint32_t nowMs);     // STALE_CHECKS_PER_CALL signals
+SignalMask stale_mask();              // signals past their timeout
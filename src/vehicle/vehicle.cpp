@@ -0,0 +1,105 @@
+#include "vehicle.h"
+
+int32_t vehicle_get(const VehicleState &vehicle, SignalId sig)
+{
+  switch (sig)
+  {
+  case SIG_RPM:
+    return vehicle.rpm;
+  case SIG_MAP:
+    return vehicle.map_kpa;
+  case SIG_LAMBDA:
+    return vehicle.lambda;
+  case SIG_TPS:
+    return vehicle.tps;
+  case SIG_CLT:
+    return vehicle.clt;
+  case SIG_IAT:
+    return vehicle.iat;
+  case SIG_OILP:
+    return vehicle.oilp;
+  case SIG_SPEED:
+    return vehicle.speed;
+  case SIG_ODO:
+    return vehicle.odo;
+  case SIG_TRIP:
+    return vehicle.trip;
+  case SIG_GEAR:
+    return vehicle.gear;
+  case SIG_PRND:
+    return vehicle.prnd;
+  case SIG_DRIVE_MODE:
+    return vehicle.driveMode;
+  default:
+    return 0;
+  }
+}
+
+// Store value (already in the field's units), truncated to the field type.
+// Returns true if the field changed.
+#define VEHICLE_SET(field)                                       \
+  {                                                              \
+    decltype(vehicle.field) v = (decltype(vehicle.field))value;  \
+    if (vehicle.field == v)                                      \
+      return false;                                              \
+    vehicle.field = v;                                           \
+    return true;                                                 \
+  }
+
+bool vehicle_set(VehicleState &vehicle, SignalId sig, int32_t value)
+{
+  switch (sig)
+  {
+  case SIG_RPM:
+    VEHICLE_SET(rpm);
+  case SIG_MAP:
+    VEHICLE_SET(map_kpa);
+  case SIG_LAMBDA:
+    VEHICLE_SET(lambda);
+  case SIG_TPS:
+    VEHICLE_SET(tps);
+  case SIG_CLT:
+    VEHICLE_SET(clt);
+  case SIG_IAT:
+    VEHICLE_SET(iat);
+  case SIG_OILP:
+    VEHICLE_SET(oilp);
+  case SIG_SPEED:
+    VEHICLE_SET(speed);
+  case SIG_ODO:
+    VEHICLE_SET(odo);
+  case SIG_TRIP:
+    VEHICLE_SET(trip);
+  case SIG_GEAR:
+    VEHICLE_SET(gear);
+  case SIG_PRND:
+    VEHICLE_SET(prnd);
+  case SIG_DRIVE_MODE:
+    VEHICLE_SET(driveMode);
+  default:
+    return false;
+  }
+}
+
+uint8_t vehicle_scale(SignalId sig)
+{
+  switch (sig)
+  {
+  case SIG_LAMBDA:
+    return 3;
+  case SIG_OILP:
+  case SIG_SPEED:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+SignalMask vehicle_diff(const VehicleState &a, const VehicleState &b)
+{
+  SignalMask diff = 0;
+  for (uint8_t s = 0; s < SIG_COUNT; s++)
+    if (vehicle_get(a, (SignalId)s) != vehicle_get(b, (SignalId)s))
+      diff |= SIG_BIT(s);
+  return diff;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "types.h"
+
+int32_t vehicle_get(const VehicleState &vehicle, SignalId sig);
+bool vehicle_set(VehicleState &vehicle, SignalId sig, int32_t value);
+// Decimal digits in the field's fixed point (lambda: 3)
+uint8_t vehicle_scale(SignalId sig);
+
+// Fields that differ between a and b
+SignalMask vehicle_diff(const VehicleState &a, const VehicleState &b);
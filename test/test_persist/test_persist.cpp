@@ -0,0 +1,217 @@
+// Persistence on the host EEPROM (lib/native_harness/src/native_eeprom.cpp):
+//   pio test -e native
+// A save cut off after any number of byte writes must leave the previous
+// record as the one that loads.
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <unity.h>
+#include "native_harness.h"
+#include "persist/persist.h"
+#include "stats/stats.h"
+
+#define EEPROM_SIZE (E2END + 1)
+#define MAX_SERVICE_CALLS 10000
+
+// -------- EEPROM images --------
+
+static void eeprom_erase()
+{
+  uint8_t blank[EEPROM_SIZE];
+  memset(blank, 0xFF, sizeof(blank));
+  FILE *f = tmpfile();
+  fwrite(blank, 1, sizeof(blank), f);
+  rewind(f);
+  native_eeprom_load(f);
+  fclose(f);
+}
+
+static FILE *eeprom_snapshot()
+{
+  FILE *f = tmpfile();
+  native_eeprom_save(f);
+  return f;
+}
+
+static void eeprom_restore(FILE *f)
+{
+  rewind(f);
+  native_eeprom_load(f);
+}
+
+// -------- Driving persist_service() --------
+
+// One task run per PERSIST_PERIOD_MS, as the scheduler does
+static void service(const VehicleState &vehicle)
+{
+  native_clock_advance_us(PERSIST_PERIOD_MS * 1000UL);
+  persist_service(vehicle, millis());
+}
+
+static void save_all(const VehicleState &vehicle)
+{
+  native_clock_advance_us(PERSIST_SAVE_MS * 1000UL);
+  for (uint16_t i = 0; i < MAX_SERVICE_CALLS; i++)
+  {
+    service(vehicle);
+    if (i > 0 && !persist_busy())
+      return;
+  }
+  TEST_FAIL_MESSAGE("save did not finish");
+}
+
+static void wait_ms(uint32_t ms)
+{
+  native_clock_advance_us(ms * 1000UL);
+}
+
+// Starts a save and stops it after `writes` EEPROM byte writes
+static void save_cut(const VehicleState &vehicle, uint32_t writes)
+{
+  uint32_t start = native_eeprom_stats().writes;
+  native_clock_advance_us(PERSIST_SAVE_MS * 1000UL);
+  for (uint16_t i = 0; i < MAX_SERVICE_CALLS; i++)
+  {
+    if (native_eeprom_stats().writes - start >= writes)
+      return;
+    service(vehicle);
+  }
+  TEST_FAIL_MESSAGE("save did not reach the cut");
+}
+
+static VehicleState boot()
+{
+  VehicleState vehicle;
+  stats_reset();
+  persist_init(vehicle);
+  return vehicle;
+}
+
+// -------- Tests --------
+
+void setUp()
+{
+  eeprom_erase();
+}
+
+void tearDown()
+{
+}
+
+static void test_blank_eeprom_loads_nothing()
+{
+  VehicleState vehicle;
+  TEST_ASSERT_FALSE(persist_init(vehicle));
+  TEST_ASSERT_EQUAL_UINT32(ODO_INITIAL_KM, vehicle.odo);
+}
+
+static void test_saved_record_loads()
+{
+  VehicleState vehicle = boot();
+  vehicle.odo = 424000;
+  vehicle.trip = 12;
+  stats_update(SIG_RPM, 7000);
+  save_all(vehicle);
+
+  VehicleState loaded = boot();
+  TEST_ASSERT_EQUAL_UINT32(424000, loaded.odo);
+  TEST_ASSERT_EQUAL_UINT32(12, loaded.trip);
+  TEST_ASSERT_EQUAL_INT32(7000, stats_get(SIG_RPM).max);
+}
+
+static void test_cut_save_keeps_previous_record()
+{
+  // Go round the ring once, so the slot being cut holds an older record
+  VehicleState vehicle = boot();
+  for (uint8_t i = 0; i < persist_slot_count(); i++)
+  {
+    vehicle.odo = 423990 + i;
+    save_all(vehicle);
+  }
+  vehicle.odo = 424000;
+  save_all(vehicle);
+  uint16_t seq = persist_seq();
+  FILE *before = eeprom_snapshot();
+
+  // Bytes the next save writes
+  vehicle = boot();
+  vehicle.odo = 424001;
+  vehicle.trip = 1;
+  uint32_t start = native_eeprom_stats().writes;
+  save_all(vehicle);
+  uint32_t total = native_eeprom_stats().writes - start;
+  TEST_ASSERT_TRUE(total > 1);
+
+  // Cut at every point: only the last byte (seq) makes it the newest
+  for (uint32_t writes = 0; writes <= total; writes++)
+  {
+    eeprom_restore(before);
+    vehicle = boot();
+    vehicle.odo = 424001;
+    vehicle.trip = 1;
+    save_cut(vehicle, writes);
+
+    VehicleState loaded = boot();
+    TEST_ASSERT_EQUAL_UINT32(writes < total ? 424000 : 424001, loaded.odo);
+    TEST_ASSERT_EQUAL_UINT16(writes < total ? seq : seq + 1, persist_seq());
+  }
+  fclose(before);
+}
+
+static void test_new_km_saves_early()
+{
+  VehicleState vehicle = boot();
+  save_all(vehicle);
+  vehicle.odo++;
+  service(vehicle);
+  TEST_ASSERT_FALSE(persist_busy()); // too soon after the last save
+  wait_ms(PERSIST_EVENT_MIN_MS);
+  service(vehicle);
+  TEST_ASSERT_TRUE(persist_busy());
+}
+
+static void test_stopping_saves_early()
+{
+  VehicleState vehicle = boot();
+  vehicle.speed = 500;
+  save_all(vehicle);
+  wait_ms(PERSIST_EVENT_MIN_MS);
+  vehicle.trip = 1; // distance since, under a km
+  service(vehicle);
+  TEST_ASSERT_FALSE(persist_busy());
+  vehicle.speed = 0;
+  service(vehicle);
+  TEST_ASSERT_TRUE(persist_busy());
+}
+
+// Speed flickering 0/1 in a crawl, stats changing on every sample: event
+// saves stay PERSIST_EVENT_MIN_MS apart
+static void test_flickering_speed_saves_bounded()
+{
+  VehicleState vehicle = boot();
+  save_all(vehicle);
+  uint16_t seq = persist_seq();
+  const uint32_t runMs = 60000;
+  for (uint32_t t = 0; t < runMs; t += PERSIST_PERIOD_MS)
+  {
+    vehicle.speed = (t / PERSIST_PERIOD_MS) & 1;
+    stats_update(SIG_RPM, 800 + (t & 0xFF));
+    service(vehicle);
+  }
+  while (persist_busy())
+    service(vehicle);
+  uint16_t saves = persist_seq() - seq;
+  TEST_ASSERT_TRUE(saves > 0);
+  TEST_ASSERT_TRUE(saves <= runMs / PERSIST_EVENT_MIN_MS + 1);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_blank_eeprom_loads_nothing);
+  RUN_TEST(test_saved_record_loads);
+  RUN_TEST(test_cut_save_keeps_previous_record);
+  RUN_TEST(test_new_km_saves_early);
+  RUN_TEST(test_stopping_saves_early);
+  RUN_TEST(test_flickering_speed_saves_bounded);
+  return UNITY_END();
+}
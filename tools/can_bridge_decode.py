@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Turn the slcan bridge's binary frames into a candump log.
+
+The ASCII bridge is read by slcand; the binary variant (B1, see
+src/can/slcan.h) is for links too slow for ASCII at full bus load. Reads a
+capture file, or a serial port when --baud is given (needs pyserial, and
+opens the bridge itself):
+
+  tools/can_bridge_decode.py capture.bin > bus.log
+  tools/can_bridge_decode.py /dev/ttyUSB0 --baud 1000000 > bus.log
+
+The output replays with canplayer, or with the native harness's --replay.
+Frame times are the firmware's 16-bit ms stamps, unwrapped. Drop and
+overrun reports are counted and shown on stderr; so are bad packets, which
+includes a capture's console text up to the first delimiter.
+"""
+import argparse
+import sys
+import time
+
+FLAG_EXT = 0x10
+FLAG_RTR = 0x20
+FLAG_DROPS = 0x80
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, out, iface):
+        self.out = out
+        self.iface = iface
+        self.t = None  # unwrapped ms
+        self.last = 0
+        self.frames = self.bad = self.dropped = self.overruns = 0
+
+    def packet(self, wire):
+        try:
+            raw = cobs_decode(wire)
+        except ValueError:
+            self.bad += 1
+            return
+        if not raw:
+            self.bad += 1
+            return
+        flags = raw[0]
+        if flags & FLAG_DROPS:
+            if len(raw) == 5:
+                self.dropped += raw[1] | raw[2] << 8
+                self.overruns += raw[3] | raw[4] << 8
+            else:
+                self.bad += 1
+            return
+
+        length = flags & 0x0F
+        idlen = 4 if flags & FLAG_EXT else 2
+        data = b"" if flags & FLAG_RTR else raw[1 + idlen + 2:]
+        if length > 8 or len(data) != (0 if flags & FLAG_RTR else length):
+            self.bad += 1
+            return
+        can_id = int.from_bytes(raw[1:1 + idlen], "little")
+        stamp = raw[1 + idlen] | raw[2 + idlen] << 8
+        if self.t is None:
+            self.t = stamp
+        else:
+            self.t += (stamp - self.last) & 0xFFFF
+        self.last = stamp
+
+        ident = f"{can_id:08X}" if flags & FLAG_EXT else f"{can_id:03X}"
+        payload = "R" if flags & FLAG_RTR else data.hex().upper()
+        self.out.write(f"({self.t / 1000:.6f}) {self.iface} {ident}#{payload}\n")
+        self.frames += 1
+
+    def feed(self, chunks):
+        buf = bytearray()
+        for chunk in chunks:
+            buf += chunk
+            while True:
+                end = buf.find(0)
+                if end < 0:
+                    break
+                if end:
+                    self.packet(bytes(buf[:end]))
+                del buf[:end + 1]
+
+
+def file_chunks(path):
+    with open(path, "rb") as f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def serial_chunks(port, baud):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        time.sleep(2)  # opening the port resets the board
+        ser.reset_input_buffer()
+        ser.write(b"b\rB1\rO\r")
+        ser.timeout = 1
+        ser.read(3)  # a CR per command, before the first packet
+        ser.timeout = 0.1
+        try:
+            while True:
+                chunk = ser.read(4096)
+                if chunk:
+                    yield chunk
+        except KeyboardInterrupt:
+            ser.write(b"C\rb\r")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("source", help="capture file, or serial port with --baud")
+    ap.add_argument("--baud", type=int, help="read a serial port at this rate")
+    ap.add_argument("--iface", default="can0", help="interface name in the log")
+    args = ap.parse_args()
+
+    dec = Decoder(sys.stdout, args.iface)
+    if args.baud:
+        dec.feed(serial_chunks(args.source, args.baud))
+    else:
+        dec.feed(file_chunks(args.source))
+    print(f"{dec.frames} frames, {dec.dropped} dropped in the firmware, "
+          f"{dec.overruns} MCP2515 overruns, {dec.bad} bad", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
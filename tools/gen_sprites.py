@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""Build src/sprites.h: the main page's gear, PRND and drive mode images,
+plus the ASCII-art sprites in tools/sprites.txt.
+
+The gear, PRND and drive mode images are the firmware's own font drawing,
+rasterized here from the U8g2 library's font data (src/clib/u8g2_fonts.c)
+by replaying the draw calls the main page used to make. They come out
+pixel for pixel as U8g2 draws them, and follow the library version in
+lib_deps.
+
+Sprites are stored the way the SSD1306 buffer is laid out: 8-pixel-tall
+pages, one byte per column, LSB = top row. ui_blit() copies them straight
+into the U8g2 frame buffer. Each rasterized group is cropped to its
+bounding box; SPR_<GROUP>_X/_Y give the box's offset from the anchor the
+draw call used.
+
+Runs before every build as a PlatformIO extra script (platformio.ini),
+and by hand:
+    python3 tools/gen_sprites.py --u8g2 .pio/libdeps/<env>/U8g2
+"""
+import argparse
+import os
+import re
+import sys
+
+# -------- U8g2 fonts --------
+
+
+def c_string_bytes(body):
+    """Bytes of adjacent C string literals (as in u8g2_fonts.c)."""
+    out = bytearray()
+    escapes = {"n": 10, "t": 9, "r": 13, "a": 7, "b": 8, "f": 12, "v": 11,
+               "\\": 92, '"': 34, "'": 39, "?": 63}
+    for lit in re.findall(r'"((?:[^"\\]|\\.)*)"', body, re.S):
+        i = 0
+        while i < len(lit):
+            ch = lit[i]
+            if ch != "\\":
+                out.append(ord(ch))
+                i += 1
+                continue
+            i += 1
+            m = re.match(r"[0-7]{1,3}", lit[i:])
+            if m:
+                out.append(int(m.group(0), 8) & 0xFF)
+                i += len(m.group(0))
+            elif lit[i] == "x":
+                m = re.match(r"[0-9a-fA-F]+", lit[i + 1:])
+                out.append(int(m.group(0), 16) & 0xFF)
+                i += 1 + len(m.group(0))
+            else:
+                out.append(escapes[lit[i]])
+                i += 1
+    return bytes(out)
+
+
+def load_fonts(u8g2_dir, names):
+    path = os.path.join(u8g2_dir, "src", "clib", "u8g2_fonts.c")
+    with open(path, encoding="latin-1") as f:
+        text = f.read()
+    fonts = {}
+    for name in names:
+        m = re.search(r"\bu8g2_font_" + name + r"\[\d+\][^=]*=((?:\s*\"(?:[^\"\\]|\\.)*\")+)\s*;", text)
+        if not m:
+            sys.exit(f"{path}: no u8g2_font_{name}")
+        fonts[name] = Font(c_string_bytes(m.group(1)))
+    return fonts
+
+
+class Bits:
+    """U8g2's glyph bit reader: LSB first within each byte."""
+
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+        self.bit = 0
+
+    def get(self, cnt):
+        val = self.data[self.pos] >> self.bit
+        end = self.bit + cnt
+        if end >= 8:
+            self.pos += 1
+            if self.pos < len(self.data):
+                val |= self.data[self.pos] << (8 - self.bit)
+            end -= 8
+        self.bit = end
+        return val & ((1 << cnt) - 1)
+
+    def get_signed(self, cnt):
+        return self.get(cnt) - (1 << (cnt - 1))
+
+
+class Glyph:
+    def __init__(self, w, h, x, y, delta, pixels):
+        self.w, self.h, self.x, self.y, self.delta = w, h, x, y, delta
+        self.pixels = pixels  # (col, row) set in the glyph box
+
+
+class Font:
+    """A U8g2 font blob, as u8g2_font_decode_glyph() reads it."""
+
+    def __init__(self, data):
+        self.data = data
+        (self.bits_0, self.bits_1, self.bits_w, self.bits_h,
+         self.bits_x, self.bits_y, self.bits_d) = data[2:9]
+        self.start_A = data[17] << 8 | data[18]
+        self.start_a = data[19] << 8 | data[20]
+
+    def glyph(self, ch):
+        enc = ord(ch)
+        p = 23
+        if enc >= ord("a"):
+            p += self.start_a
+        elif enc >= ord("A"):
+            p += self.start_A
+        while self.data[p + 1] != 0:
+            if self.data[p] == enc:
+                return self.decode(p + 2)
+            p += self.data[p + 1]
+        sys.exit(f"glyph {ch!r} not in font")
+
+    def decode(self, p):
+        b = Bits(self.data, p)
+        w = b.get(self.bits_w)
+        h = b.get(self.bits_h)
+        x = b.get_signed(self.bits_x)
+        y = b.get_signed(self.bits_y)
+        delta = b.get_signed(self.bits_d)
+        pixels = []
+        if w > 0:
+            pos = 0
+            while True:
+                zeros = b.get(self.bits_0)
+                ones = b.get(self.bits_1)
+                while True:
+                    pos += zeros
+                    pixels.extend((i % w, i // w) for i in range(pos, pos + ones))
+                    pos += ones
+                    if b.get(1) == 0:
+                        break
+                if pos // w >= h:
+                    break
+        return Glyph(w, h, x, y, delta, pixels)
+
+    def str_width(self, s):
+        """u8g2_GetStrWidth(): advances, but the last glyph's real extent."""
+        w = 0
+        g = None
+        for ch in s:
+            g = self.glyph(ch)
+            w += g.delta
+        if g is not None and g.w != 0:
+            w += g.x + g.w - g.delta
+        return w & 0xFF  # u8g2_uint_t
+
+
+# -------- Drawing, as U8g2 does it --------
+
+
+class Canvas:
+    """Pixels set in color 1; font mode transparent, as the main page left it."""
+
+    def __init__(self):
+        self.on = set()
+
+    def pixel(self, x, y, color):
+        if color:
+            self.on.add((x, y))
+        else:
+            self.on.discard((x, y))
+
+    def box(self, x, y, w, h, color=1):
+        for yy in range(y, y + h):
+            for xx in range(x, x + w):
+                self.pixel(xx, yy, color)
+
+    def vline(self, x, y, h):
+        self.box(x, y, 1, h)
+
+    def disc_section(self, x, y, x0, y0, corners):
+        if "ur" in corners:
+            self.vline(x0 + x, y0 - y, y + 1)
+            self.vline(x0 + y, y0 - x, x + 1)
+        if "ul" in corners:
+            self.vline(x0 - x, y0 - y, y + 1)
+            self.vline(x0 - y, y0 - x, x + 1)
+        if "lr" in corners:
+            self.vline(x0 + x, y0, y + 1)
+            self.vline(x0 + y, y0, x + 1)
+        if "ll" in corners:
+            self.vline(x0 - x, y0, y + 1)
+            self.vline(x0 - y, y0, x + 1)
+
+    def disc(self, x0, y0, r, corners):
+        f = 1 - r
+        ddf_x = 1
+        ddf_y = -2 * r
+        x, y = 0, r
+        self.disc_section(x, y, x0, y0, corners)
+        while x < y:
+            if f >= 0:
+                y -= 1
+                ddf_y += 2
+                f += ddf_y
+            x += 1
+            ddf_x += 2
+            f += ddf_x
+            self.disc_section(x, y, x0, y0, corners)
+
+    def rbox(self, x, y, w, h, r):
+        xl, yu = x + r, y + r
+        xr, yl = x + w - r - 1, y + h - r - 1
+        self.disc(xl, yu, r, "ul")
+        self.disc(xr, yu, r, "ur")
+        self.disc(xl, yl, r, "ll")
+        self.disc(xr, yl, r, "lr")
+        ww = w - 2 * r
+        if ww >= 3:
+            self.box(xl + 1, y, ww - 2, r + 1)
+            self.box(xl + 1, yl, ww - 2, r + 1)
+        hh = h - 2 * r
+        if hh >= 3:
+            self.box(x, yu + 1, w, hh - 2)
+
+    def text(self, font, x, y, s, color=1):
+        """print() at cursor (x, baseline y); returns the new cursor x."""
+        for ch in s:
+            g = font.glyph(ch)
+            top = y - (g.h + g.y)
+            for cx, cy in g.pixels:
+                self.pixel(x + g.x + cx, top + cy, color)
+            x += g.delta
+        return x
+
+
+def c_div(a, b):
+    """C integer division (truncates toward zero)."""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b >= 0) else -q
+
+
+# The main page's former draw calls, relative to each widget's anchor.
+# Fonts and positions must stay those of src/ui/pages/page_main.cpp.
+
+GEARS = [("R", "R"), ("N", "N")] + [(str(i), str(i)) for i in range(1, 10)]
+PRNDS = ["P", "R", "N", "D"]
+MODES = [("COMFORT", "COMFORT"), ("SPORT", "SPORT"), ("SPORTP", "SPORT+"), ("MANUAL", "MANUAL")]
+
+
+def draw_gear(fonts, text):
+    # drawActualGear(d, gear, y) at (53, y)
+    c = Canvas()
+    c.rbox(0, 0, 22, 23, 3)
+    gx = c_div(128 - fonts["luBS19_te"].str_width(text), 2) - 53
+    c.text(fonts["luBS19_te"], gx, 21, text, color=0)
+    return c
+
+
+def draw_prnd(fonts, letter):
+    # drawPRND(d, prnd, x, y, ...) at (x, y)
+    c = Canvas()
+    small = fonts["5x7_tf"]
+    c.box(16, 0, 9, 13)
+    cx = c.text(fonts["t0_18b_tr"], 16, 12, letter, color=0)
+    if letter == "P":
+        c.text(small, 26, 10, "RND")
+    elif letter == "R":
+        c.text(small, 11, 10, "P")
+        c.text(small, 26, 10, "ND")
+    elif letter == "N":
+        c.text(small, cx, 12, "PR")
+        c.text(small, 26, 10, "D")
+    else:
+        c.text(small, 1, 10, "PRN")
+    return c
+
+
+def draw_mode(fonts, text):
+    # drawDriveMode(d, vehicle, boxX, boxY, false) at (boxX, boxY)
+    c = Canvas()
+    font = fonts["5x7_tf"]
+    c.text(font, c_div(15 - font.str_width(text), 2), 10, text)
+    return c
+
+
+def font_groups(fonts):
+    """(name, x, y, w, h, [(sprite, rows)]) for the rasterized groups."""
+    drawn = [
+        ("gear", [(n, draw_gear(fonts, t)) for n, t in GEARS]),
+        ("prnd", [(p, draw_prnd(fonts, p)) for p in PRNDS]),
+        ("mode", [(n, draw_mode(fonts, t)) for n, t in MODES]),
+    ]
+    groups = []
+    for name, canvases in drawn:
+        on = set().union(*(c.on for _, c in canvases))
+        x0 = min(x for x, _ in on)
+        y0 = min(y for _, y in on)
+        w = max(x for x, _ in on) - x0 + 1
+        h = max(y for _, y in on) - y0 + 1
+        sprites = []
+        for sname, c in canvases:
+            rows = ["".join("#" if (x0 + x, y0 + y) in c.on else "." for x in range(w)) for y in range(h)]
+            sprites.append((sname, rows))
+        groups.append((name, x0, y0, w, h, sprites))
+    return groups
+
+
+# -------- ASCII art --------
+
+
+def parse(path):
+    groups = []  # (name, None, None, w, h, [(sprite, rows)])
+    group = None
+    sprite = None
+    with open(path) as f:
+        for lineno, raw in enumerate(f, 1):
+            line = raw.rstrip("\n")
+            if not line.strip() or line.startswith(";"):
+                continue
+            m = re.fullmatch(r"\[(\w+) (\d+)x(\d+)\]", line)
+            if m:
+                group = (m.group(1), None, None, int(m.group(2)), int(m.group(3)), [])
+                groups.append(group)
+                sprite = None
+                continue
+            m = re.fullmatch(r"sprite (\w+)", line)
+            if m:
+                if group is None:
+                    sys.exit(f"{path}:{lineno}: sprite outside a group")
+                sprite = (m.group(1), [])
+                group[5].append(sprite)
+                continue
+            if sprite is None or not re.fullmatch(r"[#.]+", line):
+                sys.exit(f"{path}:{lineno}: unexpected line: {line!r}")
+            sprite[1].append(line)
+
+    for name, _, _, w, h, sprites in groups:
+        for sname, rows in sprites:
+            if len(rows) != h or any(len(r) != w for r in rows):
+                sys.exit(f"{path}: {name}.{sname} is not {w}x{h}")
+    return groups
+
+
+# -------- Output --------
+
+
+def pack(rows, w, h):
+    out = []
+    for page in range((h + 7) // 8):
+        for x in range(w):
+            b = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < h and rows[y][x] == "#":
+                    b |= 1 << bit
+            out.append(b)
+    return out
+
+
+def render(groups):
+    lines = [
+        "// Generated by tools/gen_sprites.py from the U8g2 fonts and tools/sprites.txt - do not edit",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "",
+        "// Column bytes per 8-row page, LSB = top row (see ui_blit())",
+    ]
+    for name, x, y, w, h, sprites in groups:
+        up = name.upper()
+        size = w * ((h + 7) // 8)
+        lines.append("")
+        if x is not None:
+            lines.append(f"#define SPR_{up}_X {x}")
+            lines.append(f"#define SPR_{up}_Y {y}")
+        lines.append(f"#define SPR_{up}_W {w}")
+        lines.append(f"#define SPR_{up}_H {h}")
+        lines.append(f"#define SPR_{up}_COUNT {len(sprites)}")
+        for i, (sname, _) in enumerate(sprites):
+            lines.append(f"#define SPR_{up}_{sname.upper()} {i}")
+        lines.append(f"const uint8_t spr_{name}[SPR_{up}_COUNT][{size}] PROGMEM = {{")
+        for sname, rows in sprites:
+            data = pack(rows, w, h)
+            lines.append(f"    // {sname}")
+            lines.append("    {")
+            for i in range(0, len(data), 12):
+                lines.append("        " + ", ".join(f"0x{b:02x}" for b in data[i:i + 12]) + ",")
+            lines.append("    },")
+        lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def generate(root, u8g2_dir):
+    fonts = load_fonts(u8g2_dir, ["luBS19_te", "t0_18b_tr", "5x7_tf"])
+    groups = font_groups(fonts) + parse(os.path.join(root, "tools", "sprites.txt"))
+    out = os.path.join(root, "src", "sprites.h")
+    text = render(groups)
+    # Only touch the header when it changes, so builds stay incremental
+    if os.path.exists(out):
+        with open(out) as f:
+            if f.read() == text:
+                return
+    with open(out, "w") as f:
+        f.write(text)
+    print(f"wrote {os.path.relpath(out, root)}: "
+          f"{sum(len(g[5]) for g in groups)} sprites in {len(groups)} groups")
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--u8g2", required=True, help="U8g2 library directory (has src/clib/u8g2_fonts.c)")
+    generate(root, ap.parse_args().u8g2)
+
+
+if __name__ == "__main__":
+    main()
+else:
+    # PlatformIO extra script: U8g2 is in this environment's lib_deps
+    Import("env")  # noqa: F821
+    generate(env.subst("$PROJECT_DIR"),  # noqa: F821
+             os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"), "U8g2"))
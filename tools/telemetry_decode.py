@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Turn the firmware's binary telemetry stream into CSV.
+
+Start the stream with 'T' on the serial console; the frame format is
+described in src/telemetry/telemetry.h. Reads a capture file, or a serial
+port when --baud is given (needs pyserial):
+
+  tools/telemetry_decode.py capture.bin > log.csv
+  tools/telemetry_decode.py /dev/ttyUSB0 --baud 1000000 --start > log.csv
+
+Frames before the first keyframe are skipped; CRC errors and sequence gaps
+are counted and reported on stderr.
+"""
+import argparse
+import sys
+
+# SignalId order, and the decimal places of each field's fixed point
+# (keep in sync with include/types.h and vehicle_scale())
+SIGNALS = [
+    ("rpm", 0), ("map_kpa", 0), ("lambda", 3), ("tps", 0), ("clt", 0),
+    ("iat", 0), ("oilp", 1), ("speed", 1), ("odo", 0), ("trip", 0),
+    ("gear", 0), ("prnd", 0), ("drive_mode", 0),
+]
+VERSION = 1
+FLAG_KEY = 0x01
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varint(buf, pos):
+    v = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        v |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return v, pos
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.values = None
+        self.t = 0
+        self.seq = None
+        self.frames = self.crc_errors = self.gaps = self.skipped = 0
+
+    def header(self):
+        self.out.write("t_ms," + ",".join(n for n, _ in SIGNALS) + "\n")
+
+    def frame(self, wire):
+        try:
+            raw = cobs_decode(wire)
+        except ValueError:
+            self.crc_errors += 1
+            return
+        if len(raw) < 6 or crc16_ccitt(raw[:-2]) != raw[-2] | raw[-1] << 8:
+            self.crc_errors += 1
+            return
+        flags, seq = raw[0], raw[1]
+        if flags >> 4 != VERSION:
+            sys.exit(f"protocol version {flags >> 4}, expected {VERSION}")
+        key = flags & FLAG_KEY
+        if self.values is None and not key:
+            self.skipped += 1
+            return
+        if self.seq is not None and seq != (self.seq + 1) & 0xFF:
+            self.gaps += 1
+            if not key:
+                # Deltas are against a frame we never saw
+                self.values = None
+                self.skipped += 1
+                return
+        self.seq = seq
+
+        pos = 2
+        t, pos = varint(raw, pos)
+        self.t = t if key else self.t + t
+        mask, pos = varint(raw, pos)
+        if key:
+            self.values = [0] * len(SIGNALS)
+        for s in range(len(SIGNALS)):
+            if mask & (1 << s):
+                d, pos = varint(raw, pos)
+                self.values[s] += unzigzag(d)
+        self.frames += 1
+        self.row()
+
+    def row(self):
+        cols = [str(self.t)]
+        for (name, scale), v in zip(SIGNALS, self.values):
+            cols.append(f"{v / 10 ** scale:.{scale}f}" if scale else str(v))
+        self.out.write(",".join(cols) + "\n")
+
+    def feed(self, chunks):
+        buf = bytearray()
+        for chunk in chunks:
+            buf += chunk
+            while True:
+                end = buf.find(0)
+                if end < 0:
+                    break
+                if end:
+                    self.frame(bytes(buf[:end]))
+                del buf[:end + 1]
+
+
+def file_chunks(path):
+    with open(path, "rb") as f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def serial_chunks(port, baud, start):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        if start:
+            ser.write(b"T")
+        try:
+            while True:
+                chunk = ser.read(4096)
+                if chunk:
+                    yield chunk
+        except KeyboardInterrupt:
+            if start:
+                ser.write(b"T")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("source", help="capture file, or serial port with --baud")
+    ap.add_argument("--baud", type=int, help="read a serial port at this rate")
+    ap.add_argument("--start", action="store_true", help="send 'T' to start (and stop) the stream")
+    args = ap.parse_args()
+
+    dec = Decoder(sys.stdout)
+    dec.header()
+    if args.baud:
+        dec.feed(serial_chunks(args.source, args.baud, args.start))
+    else:
+        dec.feed(file_chunks(args.source))
+    print(f"{dec.frames} frames, {dec.crc_errors} bad, {dec.gaps} sequence gaps, "
+          f"{dec.skipped} skipped", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()